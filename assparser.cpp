@@ -0,0 +1,178 @@
+#include "assparser.h"
+
+#include "subtitleparsers_p.h"
+
+using namespace SubtitleText;
+
+namespace {
+
+//field boundaries of a comma-separated line; the last field takes the rest
+int splitFields(const QChar *data, const Line &line, int begin, int fieldCount, int *starts, int *ends)
+{
+    int count = 0;
+    int fieldBegin = begin;
+
+    for (int i = begin; i < line.end && count < fieldCount - 1; ++i)
+    {
+        if (data[i] == QLatin1Char(','))
+        {
+            starts[count] = fieldBegin;
+            ends[count] = i;
+            ++count;
+            fieldBegin = i + 1;
+        }
+    }
+
+    starts[count] = fieldBegin;
+    ends[count] = line.end;
+    return count + 1;
+}
+
+bool fieldIs(const QChar *data, int begin, int end, const char *name)
+{
+    while (begin < end && data[begin].isSpace())
+        ++begin;
+    while (end > begin && data[end - 1].isSpace())
+        --end;
+
+    for (; *name; ++name, ++begin)
+    {
+        if (begin >= end || data[begin].toLower() != QChar(QLatin1Char(*name)).toLower())
+        {
+            return false;
+        }
+    }
+    return begin == end;
+}
+
+} // namespace
+
+void AssParser::appendPlainText(const QChar *text, int length, QString *out)
+{
+    bool inOverride = false;
+    for (int i = 0; i < length; ++i)
+    {
+        const QChar c = text[i];
+        if (inOverride)
+        {
+            inOverride = c != QLatin1Char('}');
+        }
+        else if (c == QLatin1Char('{'))
+        {
+            inOverride = true;
+        }
+        else if (c == QLatin1Char('\\') && i + 1 < length
+                 && (text[i + 1] == QLatin1Char('N') || text[i + 1] == QLatin1Char('n')))
+        {
+            *out += QLatin1Char('\n');
+            ++i;
+        }
+        else if (c == QLatin1Char('\\') && i + 1 < length && text[i + 1] == QLatin1Char('h'))
+        {
+            *out += QLatin1Char(' ');
+            ++i;
+        }
+        else
+        {
+            *out += c;
+        }
+    }
+}
+
+CueTable AssParser::parseText(const QString &text, int *malformed)
+{
+    static const int MaxFields = 16;
+
+    const QChar *data = text.constData();
+    const int size = text.size();
+
+    CueTable cues;
+    cues.reserve(size / 96, size / 3);
+
+    //v4+ default layout, used until a Format line says otherwise
+    int fieldCount = 10;
+    int startField = 1;
+    int endField = 2;
+    int textField = 9;
+
+    bool inEvents = false;
+    int skipped = 0;
+    int pos = skipBom(data, size);
+
+    QString cueText;
+
+    while (pos < size)
+    {
+        const Line line = lineAt(data, size, pos);
+        pos = line.next;
+
+        if (line.begin < line.end && data[line.begin] == QLatin1Char('['))
+        {
+            inEvents = startsWith(data, line, "[Events]");
+            continue;
+        }
+
+        if (!inEvents)
+        {
+            continue;
+        }
+
+        int starts[MaxFields];
+        int ends[MaxFields];
+
+        if (startsWith(data, line, "Format:"))
+        {
+            const int count = splitFields(data, line, line.begin + 7, MaxFields, starts, ends);
+            fieldCount = count;
+            for (int i = 0; i < count; ++i)
+            {
+                if (fieldIs(data, starts[i], ends[i], "start"))
+                    startField = i;
+                else if (fieldIs(data, starts[i], ends[i], "end"))
+                    endField = i;
+                else if (fieldIs(data, starts[i], ends[i], "text"))
+                    textField = i;
+            }
+            continue;
+        }
+
+        if (!startsWith(data, line, "Dialogue:"))
+        {
+            continue;
+        }
+
+        const int count = splitFields(data, line, line.begin + 9, fieldCount, starts, ends);
+        if (count <= qMax(qMax(startField, endField), textField))
+        {
+            ++skipped;
+            continue;
+        }
+
+        bool startOk = false;
+        bool endOk = false;
+        const qint64 start = CueTable::parseTimestamp(QStringRef(&text, starts[startField], ends[startField] - starts[startField]).trimmed(), &startOk);
+        const qint64 end = CueTable::parseTimestamp(QStringRef(&text, starts[endField], ends[endField] - starts[endField]).trimmed(), &endOk);
+        if (!startOk || !endOk)
+        {
+            ++skipped;
+            continue;
+        }
+
+        //one scratch buffer reused for every cue
+        cueText.resize(0);
+        appendPlainText(data + starts[textField], ends[textField] - starts[textField], &cueText);
+
+        cues.append(start, end, cueText);
+    }
+
+    //events are often grouped by style rather than time
+    cues.sort();
+    cues.squeeze();
+
+    if (malformed)
+    {
+        *malformed = skipped;
+    }
+
+    return cues;
+}
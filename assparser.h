@@ -0,0 +1,20 @@
+#ifndef ASSPARSER_H
+#define ASSPARSER_H
+
+#include "cuetable.h"
+
+//Single-pass Advanced SubStation Alpha / SubStation Alpha (.ass/.ssa)
+//tokeniser. Reads the [Events] Format line to locate the Start, End and
+//Text fields of each Dialogue line; override blocks ({\...}) are dropped
+//and \N / \n / \h are turned into line breaks and spaces.
+class AssParser
+{
+public:
+    static CueTable parseText(const QString &text, int *malformed = nullptr);
+
+    //Text field of an event with the markup resolved; also used for
+    //ASS tracks embedded in Matroska files.
+    static void appendPlainText(const QChar *text, int length, QString *out);
+};
+
+#endif // ASSPARSER_H
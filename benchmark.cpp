@@ -0,0 +1,776 @@
+#include "benchmark.h"
+
+#include "cuetable.h"
+#include "definitionparser.h"
+#include "lemmatizer.h"
+#include "playlistmodel.h"
+#include "subtitleloader.h"
+#include "subtitlewords.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QSet>
+#include <QMediaPlaylist>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <QUrl>
+#include <limits>
+
+namespace Benchmark
+{
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char *suite, const QString &what)
+{
+    if (!ok)
+    {
+        ++failures;
+        qWarning().noquote() << QString("%1: FAILED %2").arg(QLatin1String(suite), what);
+    }
+}
+
+//best of several runs, so a stray page fault or context switch does not count
+template <typename Work>
+qint64 bestOf(int iterations, Work work)
+{
+    qint64 best = std::numeric_limits<qint64>::max();
+    for (int i = 0; i < iterations; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        work();
+        best = qMin(best, timer.nsecsElapsed());
+    }
+    return qMax<qint64>(1, best);
+}
+
+void report(const char *suite, const char *what, qint64 nsecs, qint64 bytes, qint64 items, const char *unit)
+{
+    const double seconds = nsecs / 1e9;
+    QString line = QString("%1 %2: %3 ms").arg(QLatin1String(suite), QLatin1String(what))
+            .arg(nsecs / 1e6, 0, 'f', 2);
+    if (bytes > 0)
+    {
+        line += QString(", %1 MB/s").arg(bytes / 1e6 / seconds, 0, 'f', 1);
+    }
+    line += QString(", %1 %2/s").arg(items / seconds, 0, 'f', 0).arg(QLatin1String(unit));
+    qInfo().noquote() << line;
+}
+
+//hh:mm:ss,mmm for SubRip, hh:mm:ss.mmm for WebVTT
+QByteArray timestamp(qint64 milliseconds, char separator)
+{
+    QByteArray text = CueTable::formatTimestamp(milliseconds).toLatin1();
+    text[text.size() - 4] = separator;
+    return text;
+}
+
+//h:mm:ss.cc
+QByteArray assTimestamp(qint64 milliseconds)
+{
+    return QString("%1:%2:%3.%4")
+            .arg(milliseconds / 3600000)
+            .arg((milliseconds / 60000) % 60, 2, 10, QChar('0'))
+            .arg((milliseconds / 1000) % 60, 2, 10, QChar('0'))
+            .arg((milliseconds % 1000) / 10, 2, 10, QChar('0')).toLatin1();
+}
+
+//a season pack worth of two-line cues
+const int SyntheticCues = 50000;
+
+QByteArray syntheticSubtitles(SubtitleLoader::Format format)
+{
+    QByteArray data;
+    data.reserve(SyntheticCues * 100);
+    if (format == SubtitleLoader::WebVtt)
+    {
+        data += "WEBVTT\n\n";
+    }
+    else if (format == SubtitleLoader::SubStationAlpha)
+    {
+        data += "[Script Info]\nScriptType: v4.00+\n\n[Events]\n"
+                "Format: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text\n";
+    }
+
+    for (int i = 0; i < SyntheticCues; ++i)
+    {
+        const qint64 start = i * 2000LL;
+        switch (format)
+        {
+        case SubtitleLoader::WebVtt:
+            data += timestamp(start, '.') + " --> " + timestamp(start + 1800, '.') + " line:90%\n"
+                    + "<i>I don't think</i> we're alone here,\n"
+                    + "said the well-known captain.\n\n";
+            break;
+        case SubtitleLoader::SubStationAlpha:
+            data += "Dialogue: 0," + assTimestamp(start) + "," + assTimestamp(start + 1800) + ",Default,,0,0,0,,"
+                    + "{\\i1}I don't think{\\i0} we're alone here,\\Nsaid the well-known captain.\n";
+            break;
+        default:
+            data += QByteArray::number(i + 1) + "\r\n"
+                    + timestamp(start, ',') + " --> " + timestamp(start + 1800, ',') + "\r\n"
+                    + "<i>I don't think</i> we're alone here,\r\n"
+                    + "said the well-known captain.\r\n\r\n";
+            break;
+        }
+    }
+    return data;
+}
+
+void timeLoading(const char *suite, SubtitleLoader::Format format, int iterations)
+{
+    const QByteArray data = syntheticSubtitles(format);
+    SubtitleLoader::Stats stats;
+    const qint64 nsecs = bestOf(iterations, [&]()
+    {
+        SubtitleLoader::load(data, &stats);
+    });
+    check(stats.format == format && stats.cues == SyntheticCues && stats.malformed == 0, suite,
+          QString("synthetic file gave %1 cues as %2").arg(stats.cues).arg(SubtitleLoader::formatName(stats.format)));
+    report(suite, "decode and parse", nsecs, data.size(), stats.cues, "cues");
+}
+
+void srtSuite(int iterations)
+{
+    const char *suite = "srt";
+
+    //BOM, CRLF, a two-line cue with markup, a malformed timing and a cue without its number
+    const QByteArray fixture =
+            "\xEF\xBB\xBF" "1\r\n"
+            "00:00:01,000 --> 00:00:02,500\r\n"
+            "Hello <i>world</i>\r\n"
+            "second line\r\n"
+            "\r\n"
+            "2\r\n"
+            "00:00:03,000 --> 00:00:04,000\r\n"
+            "Another cue\r\n"
+            "\r\n"
+            "3\r\n"
+            "00:00:xx,000 --> 00:00:05,000\r\n"
+            "Malformed\r\n"
+            "\r\n"
+            "00:00:06,000 --> 00:00:07,000\r\n"
+            "No index\r\n";
+
+    SubtitleLoader::Stats stats;
+    const CueTable cues = SubtitleLoader::load(fixture, &stats);
+    check(stats.format == SubtitleLoader::SubRip, suite, "fixture not sniffed as SubRip");
+    check(cues.size() == 3 && stats.malformed == 1, suite,
+          QString("expected 3 cues and 1 malformed, got %1 and %2").arg(cues.size()).arg(stats.malformed));
+    if (cues.size() == 3)
+    {
+        check(cues.at(0).start == 1000 && cues.at(0).end == 2500, suite, "first cue timing");
+        check(cues.text(0) == "Hello <i>world</i>\nsecond line", suite, "multi-line text: " + cues.text(0));
+        check(cues.at(1).start == 3000 && cues.text(1) == "Another cue", suite, "second cue");
+        check(cues.at(2).start == 6000 && cues.at(2).end == 7000 && cues.text(2) == "No index",
+              suite, "cue without a number");
+    }
+
+    timeLoading(suite, SubtitleLoader::SubRip, iterations);
+}
+
+void webVttSuite(int iterations)
+{
+    const char *suite = "webvtt";
+
+    //header text, NOTE and STYLE blocks, a cue identifier, cue settings,
+    //short timestamps and a malformed timing
+    const QByteArray fixture =
+            "WEBVTT - fixture\n"
+            "Kind: captions\n"
+            "\n"
+            "NOTE a comment\n"
+            "that spans lines\n"
+            "\n"
+            "STYLE\n"
+            "::cue { color: yellow }\n"
+            "\n"
+            "intro\n"
+            "00:01.000 --> 00:02.000 align:start position:10%\n"
+            "<v Bob>Hi there</v>\n"
+            "\n"
+            "00:00:03.500 --> 00:00:04.000\n"
+            "Second\n"
+            "line\n"
+            "\n"
+            "bad --> 00:00:05.000\n"
+            "broken\n";
+
+    SubtitleLoader::Stats stats;
+    const CueTable cues = SubtitleLoader::load(fixture, &stats);
+    check(stats.format == SubtitleLoader::WebVtt, suite, "fixture not sniffed as WebVTT");
+    check(cues.size() == 2 && stats.malformed == 1, suite,
+          QString("expected 2 cues and 1 malformed, got %1 and %2").arg(cues.size()).arg(stats.malformed));
+    if (cues.size() == 2)
+    {
+        check(cues.at(0).start == 1000 && cues.at(0).end == 2000 && cues.text(0) == "<v Bob>Hi there</v>",
+              suite, "cue with identifier and settings");
+        check(cues.at(1).start == 3500 && cues.at(1).end == 4000 && cues.text(1) == "Second\nline",
+              suite, "multi-line cue");
+    }
+
+    timeLoading(suite, SubtitleLoader::WebVtt, iterations);
+}
+
+void assSuite(int iterations)
+{
+    const char *suite = "ass";
+
+    //events out of time order, override blocks, \N and \h, a comma in the
+    //text, a Comment line and a malformed timing
+    const QByteArray fixture =
+            "[Script Info]\n"
+            "Title: fixture\n"
+            "\n"
+            "[V4+ Styles]\n"
+            "Format: Name, Fontname, Fontsize\n"
+            "Style: Default,Arial,20\n"
+            "\n"
+            "[Events]\n"
+            "Format: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text\n"
+            "Dialogue: 0,0:00:05.00,0:00:06.50,Default,,0,0,0,,Later, with a comma\n"
+            "Dialogue: 0,0:00:01.00,0:00:02.00,Default,,0,0,0,,{\\i1}First{\\i0}\\Nline two\\hend\n"
+            "Comment: 0,0:00:03.00,0:00:04.00,Default,,0,0,0,,not shown\n"
+            "Dialogue: 0,bad,0:00:04.00,Default,,0,0,0,,broken\n";
+
+    SubtitleLoader::Stats stats;
+    const CueTable cues = SubtitleLoader::load(fixture, &stats);
+    check(stats.format == SubtitleLoader::SubStationAlpha, suite, "fixture not sniffed as SubStation Alpha");
+    check(cues.size() == 2 && stats.malformed == 1, suite,
+          QString("expected 2 cues and 1 malformed, got %1 and %2").arg(cues.size()).arg(stats.malformed));
+    if (cues.size() == 2)
+    {
+        check(cues.at(0).start == 1000 && cues.at(0).end == 2000 && cues.text(0) == "First\nline two end",
+              suite, "markup resolved: " + cues.text(0));
+        check(cues.at(1).start == 5000 && cues.at(1).end == 6500 && cues.text(1) == "Later, with a comma",
+              suite, "text field with a comma");
+    }
+
+    //the content decides the format, whatever the file was called
+    check(SubtitleLoader::sniff("\n\n[Script Info]\n") == SubtitleLoader::SubStationAlpha
+          && SubtitleLoader::sniff(QString(QChar(0xFEFF)) + "WEBVTT\n") == SubtitleLoader::WebVtt
+          && SubtitleLoader::sniff("plain text") == SubtitleLoader::Unknown, suite, "format sniffing");
+
+    timeLoading(suite, SubtitleLoader::SubStationAlpha, iterations);
+}
+
+//an "entries" response the size of a common word's, with every field the panel shows
+QByteArray syntheticResponse()
+{
+    QByteArray lexicalEntries;
+    for (int lex = 0; lex < 6; ++lex)
+    {
+        QByteArray senses;
+        for (int sense = 0; sense < 8; ++sense)
+        {
+            senses += QByteArray(sense ? "," : "")
+                    + "{\"definitions\":[\"to move swiftly on foot so that both feet leave the ground during each stride\"],"
+                    + "\"examples\":[{\"text\":\"she ran across the road \\u2014 \\\"quickly\\\"\"}],"
+                    + "\"synonyms\":[{\"text\":\"sprint\"},{\"text\":\"race\"},{\"text\":\"dash\"}],"
+                    + "\"crossReferenceMarkers\":[\"see also race\"],\"id\":\"m_en_gbus0885530.005\"}";
+        }
+        lexicalEntries += QByteArray(lex ? "," : "")
+                + "{\"entries\":[{\"pronunciations\":[{\"audioFile\":\"https://audio.oxforddictionaries.com/en/mp3/run_gb_1.mp3\","
+                + "\"phoneticSpelling\":\"r\\u028cn\"}],\"senses\":[" + senses + "]}],"
+                + "\"lexicalCategory\":{\"id\":\"verb\",\"text\":\"Verb\"},\"text\":\"run\"}";
+    }
+    return "{\"id\":\"run\",\"metadata\":{\"provider\":\"Oxford University Press\"},"
+           "\"results\":[{\"id\":\"run\",\"language\":\"en-gb\",\"lexicalEntries\":[" + lexicalEntries + "]}]}";
+}
+
+void definitionSuite(int iterations)
+{
+    const char *suite = "definitions";
+
+    //escapes, a third sense past MaxSenses and a second result that must be ignored
+    const QByteArray fixture =
+            "{\"id\":\"run\",\"results\":[{\"id\":\"run\",\"lexicalEntries\":["
+            "{\"entries\":[{\"pronunciations\":[{\"audioFile\":\"https://example.com/run.mp3\"}],"
+            "\"senses\":["
+            "{\"definitions\":[\"move at a speed faster than a walk\"],"
+            "\"examples\":[{\"text\":\"the dog ran \\\"off\\\"\"}],"
+            "\"synonyms\":[{\"text\":\"sprint\"},{\"text\":\"dash\"}]},"
+            "{\"definitions\":[\"travel a route\"],\"crossReferenceMarkers\":[\"see route\"]},"
+            "{\"definitions\":[\"third sense, not shown\"]}]}],"
+            "\"lexicalCategory\":{\"id\":\"verb\",\"text\":\"Verb\"}},"
+            "{\"entries\":[{\"senses\":[{\"definitions\":[\"an act of running \\u2014 a jog\"]}]}],"
+            "\"lexicalCategory\":{\"text\":\"Noun\"}}]},"
+            "{\"id\":\"second result\"}]}";
+
+    DictionaryEntry entry;
+    check(DefinitionParser::parse(fixture, &entry), suite, "fixture did not parse");
+    check(entry.text(entry.word) == "run", suite, "headword: " + entry.text(entry.word));
+    check(entry.lexicalEntries.size() == 2 && entry.pronunciations.size() == 1 && entry.senses.size() == 3
+          && entry.items.size() == 4, suite,
+          QString("expected 2 lexical entries, 1 pronunciation, 3 senses and 4 items, got %1, %2, %3 and %4")
+          .arg(entry.lexicalEntries.size()).arg(entry.pronunciations.size())
+          .arg(entry.senses.size()).arg(entry.items.size()));
+    if (entry.lexicalEntries.size() == 2 && entry.senses.size() == 3 && entry.items.size() == 4)
+    {
+        check(entry.text(entry.lexicalEntries.at(1).category) == "Noun", suite, "second lexical category");
+        check(entry.text(entry.items.at(0).text) == "the dog ran \"off\""
+              && entry.items.at(0).kind == DictionaryEntry::Example, suite, "escaped example");
+        check(entry.items.at(3).kind == DictionaryEntry::CrossReference && entry.items.at(3).sense == 1,
+              suite, "cross-reference of the second sense");
+        check(entry.text(entry.senses.at(2).definition) == QString("an act of running ") + QChar(0x2014) + " a jog"
+              && entry.senses.at(2).lexicalEntry == 1, suite, "\\u escape in the second lexical entry");
+    }
+
+    const QString html = DefinitionParser::renderHtml(entry);
+    check(html.contains("<b>run</b>") && html.contains("<i>Noun</i>") && html.contains("https://example.com/run.mp3")
+          && !html.contains("third sense"), suite, "rendered panel");
+
+    //bounds: no senses at all, and a truncated response
+    check(DefinitionParser::parse("{\"results\":[{\"id\":\"x\",\"lexicalEntries\":[{\"entries\":[{\"senses\":[]}]}]}]}", &entry)
+          && entry.senses.isEmpty(), suite, "entry without senses");
+    check(!DefinitionParser::parse(fixture.left(fixture.size() / 2), &entry), suite, "truncated response accepted");
+
+    //cache hits are bounded by parse and render, with the entry's arena reused
+    const QByteArray response = syntheticResponse();
+    const int lookups = 2000;
+    int rendered = 0;
+    const qint64 nsecs = bestOf(iterations, [&]()
+    {
+        rendered = 0;
+        for (int i = 0; i < lookups; ++i)
+        {
+            if (DefinitionParser::parse(response, &entry) && !DefinitionParser::renderHtml(entry).isEmpty())
+            {
+                ++rendered;
+            }
+        }
+    });
+    check(rendered == lookups && entry.senses.size() == 6 * DefinitionParser::MaxSenses, suite,
+          QString("synthetic response gave %1 senses").arg(entry.senses.size()));
+    report(suite, "parse and render", nsecs, qint64(response.size()) * lookups, rendered, "lookups");
+}
+
+QString title(const PlaylistModel &model, int row)
+{
+    return model.data(model.index(row, PlaylistModel::Title)).toString();
+}
+
+QVariant role(const PlaylistModel &model, int row, int role)
+{
+    return model.data(model.index(row, PlaylistModel::Title), role);
+}
+
+//file probes land through the event loop; wait until every row has one
+bool waitForProbes(PlaylistModel *model, int timeout = 5000)
+{
+    const auto probed = [model]()
+    {
+        for (int row = 0; row < model->rowCount(); ++row)
+        {
+            if (role(*model, row, PlaylistModel::SubtitleRole).toInt() == PlaylistModel::SubtitlesUnknown)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    QEventLoop loop;
+    QTimer::singleShot(timeout, &loop, &QEventLoop::quit);
+    QObject::connect(model, &QAbstractItemModel::dataChanged, &loop, [&]()
+    {
+        if (probed())
+        {
+            loop.quit();
+        }
+    });
+
+    if (!probed())
+    {
+        loop.exec();
+    }
+    return probed();
+}
+
+void playlistSuite(int iterations)
+{
+    const char *suite = "playlist";
+
+    //a sidecar, an embedded-capable container, neither, and an upper-case
+    //sidecar, with distinct sizes
+    QTemporaryDir directory;
+    const QStringList files = {"a.mkv", "a.srt", "b.mp4", "c.avi", "d.avi", "d.SRT"};
+    for (int i = 0; i < files.size(); ++i)
+    {
+        QFile file(directory.filePath(files.at(i)));
+        if (file.open(QIODevice::WriteOnly))
+        {
+            file.write(QByteArray((i + 1) * 10, 'x'));
+        }
+    }
+
+    {
+        PlaylistModel model;
+        QMediaPlaylist *playlist = new QMediaPlaylist;
+        model.setPlaylist(playlist);
+        QList<QMediaContent> media;
+        for (const QString &file : {"a.mkv", "b.mp4", "c.avi", "d.avi"})
+        {
+            media.push_back(QMediaContent(QUrl::fromLocalFile(directory.filePath(file))));
+        }
+        playlist->addMedia(media);
+
+        check(model.rowCount() == 4 && title(model, 1) == "b.mp4", suite, "rows after a batched insert");
+        check(waitForProbes(&model), suite, "file probes never arrived");
+        check(role(model, 0, PlaylistModel::SubtitleRole).toInt() == PlaylistModel::SubtitlesSidecar
+              && role(model, 1, PlaylistModel::SubtitleRole).toInt() == PlaylistModel::SubtitlesEmbedded
+              && role(model, 2, PlaylistModel::SubtitleRole).toInt() == PlaylistModel::SubtitlesNone
+              && role(model, 3, PlaylistModel::SubtitleRole).toInt() == PlaylistModel::SubtitlesSidecar,
+              suite, "subtitle status from the directory listing");
+        check(role(model, 0, PlaylistModel::FileSizeRole).toLongLong() == 10
+              && role(model, 1, PlaylistModel::FileSizeRole).toLongLong() == 30
+              && role(model, 2, PlaylistModel::FileSizeRole).toLongLong() == 40, suite, "file sizes");
+
+        //cached metadata has to follow its row through removes and inserts
+        model.setData(model.index(2, 0), 60000, PlaylistModel::DurationRole);
+        playlist->removeMedia(0);
+        check(model.rowCount() == 3 && title(model, 0) == "b.mp4" && title(model, 1) == "c.avi"
+              && role(model, 1, PlaylistModel::DurationRole).toLongLong() == 60000, suite, "rows after a remove");
+        playlist->insertMedia(0, QMediaContent(QUrl::fromLocalFile(directory.filePath("a.mkv"))));
+        check(model.rowCount() == 4 && title(model, 0) == "a.mkv"
+              && role(model, 2, PlaylistModel::DurationRole).toLongLong() == 60000
+              && role(model, 0, PlaylistModel::DurationRole).toLongLong() == -1, suite, "rows after an insert");
+    }
+
+    //a large course: one batched insert, then a scroll through every row
+    const int rows = 50000;
+    QList<QMediaContent> media;
+    media.reserve(rows);
+    for (int i = 0; i < rows; ++i)
+    {
+        media.push_back(QMediaContent(QUrl::fromLocalFile(QString("/course/episode%1.mkv").arg(i, 5, 10, QChar('0')))));
+    }
+
+    qint64 insertNsecs = std::numeric_limits<qint64>::max();
+    qint64 scrollNsecs = std::numeric_limits<qint64>::max();
+    int inserts = 0;
+    int painted = 0;
+    for (int i = 0; i < qMax(1, iterations); ++i)
+    {
+        PlaylistModel model;
+        QMediaPlaylist *playlist = new QMediaPlaylist;
+        model.setPlaylist(playlist);
+        inserts = 0;
+        QObject::connect(&model, &QAbstractItemModel::rowsInserted, [&inserts]()
+        {
+            ++inserts;
+        });
+
+        QElapsedTimer timer;
+        timer.start();
+        playlist->addMedia(media);
+        insertNsecs = qMin(insertNsecs, timer.nsecsElapsed());
+
+        //what a view asks for each row it paints
+        timer.restart();
+        painted = 0;
+        for (int row = 0; row < model.rowCount(); ++row)
+        {
+            const QModelIndex index = model.index(row, PlaylistModel::Title);
+            if (!model.data(index).toString().isEmpty())
+            {
+                ++painted;
+            }
+            model.data(index, PlaylistModel::SubtitleRole);
+            model.data(index, PlaylistModel::DurationRole);
+        }
+        scrollNsecs = qMin(scrollNsecs, timer.nsecsElapsed());
+
+        check(model.rowCount() == rows && inserts == 1 && title(model, 12345) == "episode12345.mkv", suite,
+              QString("large insert gave %1 rows in %2 inserts").arg(model.rowCount()).arg(inserts));
+    }
+    check(painted == rows, suite, QString("%1 rows without a title").arg(rows - painted));
+    report(suite, "insert", qMax<qint64>(1, insertNsecs), 0, rows, "rows");
+    report(suite, "scroll", qMax<qint64>(1, scrollNsecs), 0, painted, "rows");
+
+    //the same course on disk, every tenth episode with an upper-case sidecar:
+    //the probe lists the folder once for all of them
+    QTemporaryDir course;
+    QList<QMediaContent> episodes;
+    episodes.reserve(rows);
+    for (int i = 0; i < rows; ++i)
+    {
+        const QString name = QString("episode%1").arg(i, 5, 10, QChar('0'));
+        QFile video(course.filePath(name + ".mkv"));
+        QFile sidecar(course.filePath(name + ".SRT"));
+        if (!video.open(QIODevice::WriteOnly) || (i % 10 == 0 && !sidecar.open(QIODevice::WriteOnly)))
+        {
+            check(false, suite, "cannot create the course files in " + course.path());
+            return;
+        }
+        episodes.push_back(QMediaContent(QUrl::fromLocalFile(video.fileName())));
+    }
+
+    qint64 probeNsecs = std::numeric_limits<qint64>::max();
+    for (int i = 0; i < qMax(1, iterations); ++i)
+    {
+        PlaylistModel model;
+        QMediaPlaylist *playlist = new QMediaPlaylist;
+        model.setPlaylist(playlist);
+
+        QElapsedTimer timer;
+        timer.start();
+        playlist->addMedia(episodes);
+        const bool probed = waitForProbes(&model, 60000);
+        probeNsecs = qMin(probeNsecs, timer.nsecsElapsed());
+
+        int sidecars = 0;
+        for (int row = 0; row < model.rowCount(); ++row)
+        {
+            if (role(model, row, PlaylistModel::SubtitleRole).toInt() == PlaylistModel::SubtitlesSidecar)
+            {
+                ++sidecars;
+            }
+        }
+        check(probed && sidecars == rows / 10 && role(model, 1, PlaylistModel::FileSizeRole).toLongLong() == 0,
+              suite, QString("probing the course found %1 sidecars").arg(sidecars));
+    }
+    report(suite, "probe", probeNsecs, 0, rows, "files");
+}
+
+QStringList tokens(const QString &text)
+{
+    QVector<SubtitleWords::Span> spans;
+    SubtitleWords::tokenize(text.constData(), text.size(), &spans);
+
+    QStringList words;
+    for (const SubtitleWords::Span &span : spans)
+    {
+        words.push_back(text.mid(span.offset, span.length));
+    }
+    return words;
+}
+
+void tokenizerSuite(int iterations)
+{
+    const char *suite = "tokenizer";
+
+    //markup, joiners inside and around words, accented letters and a typographic apostrophe
+    const QString mixed = QString::fromUtf8(
+            "<i>Don't</i> say it's well-known, {\\an8}caf\xc3\xa9 -- na\xc3\xafve 'quoted' "
+            "rock'n'roll x-ray 42 e-mail\xe2\x80\x99s end-");
+    const QStringList mixedWords = QString::fromUtf8(
+            "Don't say it's well-known caf\xc3\xa9 na\xc3\xafve quoted rock'n'roll x-ray e-mail\xe2\x80\x99s end")
+            .split(' ');
+    const QString ascii = "The well-known captain didn't think we'd get there in time, did he?";
+    const QStringList asciiWords = QString("The well-known captain didn't think we'd get there in time did he").split(' ');
+
+    check(tokens(mixed) == mixedWords, suite, "mixed text: " + tokens(mixed).join('|'));
+    check(tokens(ascii) == asciiWords, suite, "ASCII text: " + tokens(ascii).join('|'));
+
+    //shifting the text across vector block edges must not change a single word
+    for (int pad = 1; pad <= 40; ++pad)
+    {
+        const QString padding(pad, QLatin1Char(pad % 3 ? ' ' : '.'));
+        if (tokens(padding + ascii + padding + ascii) != asciiWords + asciiWords
+                || tokens(padding + mixed + padding + ascii) != mixedWords + asciiWords)
+        {
+            check(false, suite, QString("words change with %1 units of padding").arg(pad));
+            break;
+        }
+    }
+
+    check(SubtitleWords::wordAt("say well-known things", 7) == "well-known"
+          && SubtitleWords::wordsOf(QStringRef(&mixed)).contains("don't"), suite, "word lookups");
+
+    //spans are found once when cues are loaded
+    CueTable cues;
+    cues.append(0, 1000, mixed);
+    cues.append(1000, 2000, ascii);
+    check(cues.tokenCount(0) == mixedWords.size() && cues.tokenCount(1) == asciiWords.size()
+          && cues.tokenRef(1, 1).toString() == "well-known", suite, "cue token spans");
+
+    //mostly ASCII dialogue takes the vector path, accented text the scalar one
+    for (const QString &line : {ascii, mixed})
+    {
+        QString text;
+        text.reserve(line.size() * 40000 + 40000);
+        for (int i = 0; i < 40000; ++i)
+        {
+            text += line;
+            text += QLatin1Char('\n');
+        }
+
+        QVector<SubtitleWords::Span> spans;
+        spans.reserve(text.size() / 4);
+        const qint64 nsecs = bestOf(iterations, [&]()
+        {
+            spans.resize(0);
+            SubtitleWords::tokenize(text.constData(), text.size(), &spans);
+        });
+        check(spans.size() == 40000 * tokens(line).size(), suite, QString("%1 spans").arg(spans.size()));
+        report(suite, line == ascii ? "ASCII" : "mixed", nsecs, text.size() * qint64(sizeof(QChar)), spans.size(), "tokens");
+    }
+}
+
+//QSet::fromList() is deprecated from Qt 5.14, and the range constructor
+//replacing it is not in older releases
+int distinct(const QStringList &words)
+{
+    QSet<QString> set;
+    for (const QString &word : words)
+    {
+        set.insert(word);
+    }
+    return set.size();
+}
+
+void lemmatizerSuite(int iterations)
+{
+    const char *suite = "lemmatizer";
+
+    const QStringList forms = {
+        "running", "ran", "Runs", "children", "went", "stopped", "making", "danced", "cities", "boxes",
+        "kissed", "agreed", "related", "studied", "dog's", "morning", "news", "status", "bus",
+        "decided", "realized", "amazing", "closed", "closing", "caused", "smiled", "writing", "buses",
+        "ourselves"
+    };
+    const QStringList lemmas = {
+        "run", "run", "run", "child", "go", "stop", "make", "dance", "city", "box",
+        "kiss", "agree", "relate", "study", "dog", "morning", "news", "status", "bus",
+        "decide", "realize", "amaze", "close", "close", "cause", "smile", "write", "bus",
+        "ourselves"
+    };
+    for (int i = 0; i < forms.size(); ++i)
+    {
+        const QString lemma = Lemmatizer::lemma(forms.at(i));
+        check(lemma == lemmas.at(i), suite, QString("%1 -> %2, expected %3").arg(forms.at(i), lemma, lemmas.at(i)));
+    }
+
+    //a guessed lemma falls back to the other guesses, then to the word as written
+    const QStringList fallbacks[] = {
+        {"visite", "visit", "visited"}, {"focuse", "focus", "focused"}, {"decide", "decid", "decided"},
+        {"run", "running"}, {"run"}, {"news"}
+    };
+    const QStringList fallbackForms = {"visited", "focused", "decided", "running", "ran", "news"};
+    for (int i = 0; i < fallbackForms.size(); ++i)
+    {
+        const QStringList keys = Lemmatizer::keys(fallbackForms.at(i));
+        check(keys == fallbacks[i], suite, QString("%1 -> %2, expected %3")
+              .arg(fallbackForms.at(i), keys.join('|'), fallbacks[i].join('|')));
+    }
+
+    //six words in 21 spellings collapse to six cache keys
+    const QStringList family = QString("run runs running ran Run make makes making made child children "
+                                       "stop stopped stopping stops city cities go goes went gone going")
+            .split(' ');
+    QStringList folded;
+    QStringList keys;
+    for (const QString &word : family)
+    {
+        folded.push_back(SubtitleWords::fold(QStringRef(&word)));
+        keys.push_back(Lemmatizer::lemma(word));
+    }
+    const int foldedKeys = distinct(folded);
+    const int lemmaKeys = distinct(keys);
+    check(foldedKeys == 21 && lemmaKeys == 6, suite,
+          QString("expected 21 folded and 6 lemma keys, got %1 and %2").arg(foldedKeys).arg(lemmaKeys));
+
+    //dialogue-like text, to see how many more lookups a cache keyed by lemma answers
+    const QString dialogue =
+            "He was running late again, so he ran for the bus. The buses were leaving and the driver "
+            "waved; she waves at everyone who runs. We have been waiting for hours and we waited "
+            "yesterday too. The children watched the other child while their parents talked and "
+            "talked about the cities they had visited, the city lights and the stopped clocks.";
+    const QStringList words = SubtitleWords::wordsOf(QStringRef(&dialogue));
+    check(words.contains("buses") && Lemmatizer::lemma("buses") == Lemmatizer::lemma("bus"), suite,
+          "\"buses\" and \"bus\" share a key");
+    QStringList corpus;
+    corpus.reserve(words.size() * 20000);
+    for (int i = 0; i < 20000; ++i)
+    {
+        corpus += words;
+    }
+
+    QStringList lemmaCorpus;
+    const qint64 nsecs = bestOf(iterations, [&]()
+    {
+        lemmaCorpus.clear();
+        lemmaCorpus.reserve(corpus.size());
+        for (const QString &word : qAsConst(corpus))
+        {
+            lemmaCorpus.push_back(Lemmatizer::lemma(word));
+        }
+    });
+    report(suite, "lemma", nsecs, 0, corpus.size(), "words");
+
+    //one pass over the text: a lookup hits when its key was looked up before
+    QStringList lemmaWords;
+    for (const QString &word : words)
+    {
+        lemmaWords.push_back(Lemmatizer::lemma(word));
+    }
+    const int distinctWords = distinct(words);
+    const int distinctLemmas = distinct(lemmaWords);
+    check(distinctLemmas < distinctWords, suite,
+          QString("lemmas merged no keys (%1 words, %2 lemmas)").arg(distinctWords).arg(distinctLemmas));
+    qInfo().noquote() << QString("%1: %2 keys folded, %3 by lemma; cache hit rate %4% -> %5%")
+                         .arg(QLatin1String(suite)).arg(distinctWords).arg(distinctLemmas)
+                         .arg(100.0 * (words.size() - distinctWords) / words.size(), 0, 'f', 1)
+                         .arg(100.0 * (words.size() - distinctLemmas) / words.size(), 0, 'f', 1);
+}
+
+struct Suite
+{
+    const char *name;
+    void (*run)(int iterations);
+};
+
+const Suite suiteTable[] = {
+    {"srt", srtSuite},
+    {"webvtt", webVttSuite},
+    {"ass", assSuite},
+    {"definitions", definitionSuite},
+    {"playlist", playlistSuite},
+    {"tokenizer", tokenizerSuite},
+    {"lemmatizer", lemmatizerSuite},
+};
+
+} // namespace
+
+QStringList suites()
+{
+    QStringList names;
+    for (const Suite &suite : suiteTable)
+    {
+        names.push_back(QLatin1String(suite.name));
+    }
+    return names;
+}
+
+int run(const QStringList &names, int iterations)
+{
+    failures = 0;
+    iterations = qMax(1, iterations);
+
+    for (const QString &name : names)
+    {
+        if (!suites().contains(name))
+        {
+            qWarning().noquote() << "Unknown benchmark" << name << "- available:" << suites().join(", ");
+            ++failures;
+        }
+    }
+
+    for (const Suite &suite : suiteTable)
+    {
+        if (names.isEmpty() || names.contains(QLatin1String(suite.name)))
+        {
+            suite.run(iterations);
+        }
+    }
+
+    return failures;
+}
+
+} // namespace Benchmark
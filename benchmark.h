@@ -0,0 +1,21 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QStringList>
+
+//Checks and throughput figures for the parsing and lookup hot paths,
+//for the --benchmark mode. Every suite first checks its results on a
+//small fixed input with known answers, then times the same code on a
+//large synthetic one; a wrong answer fails the run whatever the timings.
+namespace Benchmark
+{
+
+QStringList suites();
+
+//runs the named suites (all of them when empty), each timing the best of
+//iterations runs; returns the number of failed checks
+int run(const QStringList &suites, int iterations);
+
+} // namespace Benchmark
+
+#endif // BENCHMARK_H
@@ -0,0 +1,270 @@
+#include "cuecache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#if defined(Q_OS_WIN)
+#include <qt_windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const quint32 CACHE_MAGIC = 0x43554543; //"CUEC"
+static const quint32 CACHE_VERSION = 2;
+
+//written in native order; a cache copied to another machine is a miss
+static const quint32 BYTE_ORDER_MARK = 0x01020304;
+
+struct CacheHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint32 byteOrder;
+    quint32 cueSize;
+    qint64 sourceSize;
+    qint64 sourceModified;  //ms since epoch
+    qint32 pathLength;      //QChars, padded to a multiple of 2
+    qint32 cueCount;
+    qint32 tokenCount;
+    qint32 textLength;
+};
+
+static_assert(sizeof(CacheHeader) == 48, "cache header layout changed");
+static_assert(sizeof(CueTable::Cue) % 4 == 0 && sizeof(CueTable::Token) % 4 == 0,
+              "cues and tokens must stay 4-byte aligned");
+
+//the path is stored so a hash collision cannot serve another file's cues
+static int paddedPathLength(const QString &path)
+{
+    return (path.size() + 1) & ~1;
+}
+
+static qint64 fileBytes(int pathLength, int cueCount, int tokenCount, int textLength)
+{
+    return qint64(sizeof(CacheHeader))
+            + qint64(pathLength) * sizeof(QChar)
+            + qint64(cueCount) * sizeof(CueTable::Cue)
+            + qint64(tokenCount) * sizeof(CueTable::Token)
+            + qint64(textLength) * sizeof(QChar);
+}
+
+//Maps a whole file read-only and closes it straight away: a library of
+//cached tracks must not hold a descriptor per track. The region stays
+//mapped until the last table sharing it lets go.
+static QSharedPointer<const uchar> mapFile(const QString &fileName, qint64 *size)
+{
+#if defined(Q_OS_WIN)
+    HANDLE file = CreateFileW(reinterpret_cast<const wchar_t *>(QDir::toNativeSeparators(fileName).utf16()),
+                              GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return QSharedPointer<const uchar>();
+    }
+
+    LARGE_INTEGER length;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &length) && length.QuadPart > 0)
+    {
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    CloseHandle(file);
+    if (!mapping)
+    {
+        return QSharedPointer<const uchar>();
+    }
+
+    //the view keeps the section alive after both handles are closed
+    const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view)
+    {
+        return QSharedPointer<const uchar>();
+    }
+
+    *size = length.QuadPart;
+    return QSharedPointer<const uchar>(static_cast<const uchar *>(view),
+                                       [](const uchar *data) { UnmapViewOfFile(data); });
+#else
+    const int fd = ::open(QFile::encodeName(fileName).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return QSharedPointer<const uchar>();
+    }
+
+    struct stat info;
+    void *data = MAP_FAILED;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        data = ::mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        return QSharedPointer<const uchar>();
+    }
+
+    //QSaveFile replaces the cache by rename, so the mapped inode never shrinks
+    const size_t length = size_t(info.st_size);
+    *size = info.st_size;
+    return QSharedPointer<const uchar>(static_cast<const uchar *>(data),
+                                       [length](const uchar *mapped) { ::munmap(const_cast<uchar *>(mapped), length); });
+#endif
+}
+
+//every span a table will slice must lie inside the mapped blocks; a
+//truncated or corrupt file is a miss, not an out-of-bounds read
+static bool isConsistent(const CueTable::Cue *cues, int cueCount,
+                         const CueTable::Token *tokens, int tokenCount, int textLength)
+{
+    for (int i = 0; i < cueCount; ++i)
+    {
+        const CueTable::Cue &cue = cues[i];
+        if (cue.textOffset < 0 || cue.textLength < 0
+                || qint64(cue.textOffset) + cue.textLength > textLength
+                || cue.firstToken < 0 || cue.tokenCount < 0
+                || qint64(cue.firstToken) + cue.tokenCount > tokenCount
+                || cue.lineCount < 0)
+        {
+            return false;
+        }
+    }
+
+    for (int i = 0; i < tokenCount; ++i)
+    {
+        const CueTable::Token &token = tokens[i];
+        if (token.offset < 0 || token.length < 0 || qint64(token.offset) + token.length > textLength)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+CueCache::CueCache(const QString &directory)
+    : m_directory(directory)
+{
+}
+
+QString CueCache::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/cues";
+}
+
+QString CueCache::cacheFileName(const QString &sourceFile) const
+{
+    const QByteArray hash = QCryptographicHash::hash(QFileInfo(sourceFile).absoluteFilePath().toUtf8(),
+                                                     QCryptographicHash::Sha1);
+    return m_directory + '/' + QString::fromLatin1(hash.toHex()) + ".cues";
+}
+
+bool CueCache::load(const QString &sourceFile, CueTable *cues) const
+{
+    const QFileInfo source(sourceFile);
+    if (!source.exists())
+    {
+        return false;
+    }
+
+    qint64 size = 0;
+    const QSharedPointer<const uchar> mapping = mapFile(cacheFileName(sourceFile), &size);
+    if (!mapping || size < qint64(sizeof(CacheHeader)))
+    {
+        return false;
+    }
+
+    const uchar *mapped = mapping.data();
+
+    const CacheHeader *header = reinterpret_cast<const CacheHeader *>(mapped);
+    const QString path = source.absoluteFilePath();
+
+    if (header->magic != CACHE_MAGIC
+            || header->version != CACHE_VERSION
+            || header->byteOrder != BYTE_ORDER_MARK
+            || header->cueSize != sizeof(CueTable::Cue)
+            || header->sourceSize != source.size()
+            || header->sourceModified != source.lastModified().toMSecsSinceEpoch()
+            || header->pathLength != paddedPathLength(path)
+            || header->cueCount < 0 || header->tokenCount < 0 || header->textLength < 0
+            || fileBytes(header->pathLength, header->cueCount, header->tokenCount, header->textLength) != size)
+    {
+        return false;
+    }
+
+    const QChar *storedPath = reinterpret_cast<const QChar *>(mapped + sizeof(CacheHeader));
+    if (path != QString::fromRawData(storedPath, path.size()))
+    {
+        return false;
+    }
+
+    const uchar *data = mapped + sizeof(CacheHeader) + header->pathLength * sizeof(QChar);
+    const CueTable::Cue *cueData = reinterpret_cast<const CueTable::Cue *>(data);
+    data += header->cueCount * sizeof(CueTable::Cue);
+    const CueTable::Token *tokens = reinterpret_cast<const CueTable::Token *>(data);
+    data += header->tokenCount * sizeof(CueTable::Token);
+    const QChar *text = reinterpret_cast<const QChar *>(data);
+
+    if (!isConsistent(cueData, header->cueCount, tokens, header->tokenCount, header->textLength))
+    {
+        return false;
+    }
+
+    //the table keeps the mapping alive for as long as it is shared
+    *cues = CueTable::fromMapping(mapping, cueData, header->cueCount, tokens, header->tokenCount,
+                                  text, header->textLength);
+    return true;
+}
+
+bool CueCache::store(const QString &sourceFile, const CueTable &cues) const
+{
+    const QFileInfo source(sourceFile);
+    if (!source.exists() || !QDir().mkpath(m_directory))
+    {
+        return false;
+    }
+
+    const QString path = source.absoluteFilePath();
+
+    CacheHeader header;
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.cueSize = sizeof(CueTable::Cue);
+    header.sourceSize = source.size();
+    header.sourceModified = source.lastModified().toMSecsSinceEpoch();
+    header.pathLength = paddedPathLength(path);
+    header.cueCount = cues.size();
+    header.tokenCount = cues.tokenBufferSize();
+    header.textLength = cues.textBuffer().size();
+
+    QSaveFile file(cacheFileName(sourceFile));
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    const QChar padding[1] = {QChar()};
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(path.constData()), path.size() * sizeof(QChar));
+    file.write(reinterpret_cast<const char *>(padding), (header.pathLength - path.size()) * sizeof(QChar));
+    file.write(reinterpret_cast<const char *>(cues.constData()), header.cueCount * sizeof(CueTable::Cue));
+    file.write(reinterpret_cast<const char *>(cues.tokenData()), header.tokenCount * sizeof(CueTable::Token));
+    file.write(reinterpret_cast<const char *>(cues.textBuffer().constData()), header.textLength * sizeof(QChar));
+
+    return file.commit();
+}
+
+void CueCache::remove(const QString &sourceFile) const
+{
+    QFile::remove(cacheFileName(sourceFile));
+}
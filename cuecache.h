@@ -0,0 +1,33 @@
+#ifndef CUECACHE_H
+#define CUECACHE_H
+
+#include "cuetable.h"
+
+#include <QString>
+
+//On-disk cache of parsed cue tables, one file per subtitle source.
+//A cache file holds a fixed header, the Cue array, the word spans and
+//the UTF-16 text exactly as CueTable keeps them, so loading is a map plus a header and
+//bounds check and the returned table points straight into the mapping. The
+//file itself is closed as soon as it is mapped. Entries are
+//keyed by source path and invalidated by size, mtime or format version;
+//any mismatch is a plain miss. Stateless apart from the directory, so it
+//can be used from worker threads.
+class CueCache
+{
+public:
+    explicit CueCache(const QString &directory = defaultDirectory());
+
+    static QString defaultDirectory();
+
+    bool load(const QString &sourceFile, CueTable *cues) const;
+    bool store(const QString &sourceFile, const CueTable &cues) const;
+    void remove(const QString &sourceFile) const;
+
+    QString cacheFileName(const QString &sourceFile) const;
+
+private:
+    QString m_directory;
+};
+
+#endif // CUECACHE_H
@@ -0,0 +1,324 @@
+#include "cuetable.h"
+
+#include <algorithm>
+#include <limits>
+
+CueTable CueTable::fromMapping(const QSharedPointer<const uchar> &mapping, const Cue *cues, int count,
+                               const Token *tokens, int tokenCount, const QChar *text, int textLength)
+{
+    CueTable table;
+    table.m_mapping = mapping;
+    table.m_mappedCues = cues;
+    table.m_mappedCount = count;
+    table.m_mappedTokens = tokens;
+    table.m_mappedTokenCount = tokenCount;
+    table.m_text = QString::fromRawData(text, textLength);
+    table.updateMaxEnd();
+    return table;
+}
+
+void CueTable::detach()
+{
+    if (!m_mapping)
+    {
+        return;
+    }
+
+    m_cues.resize(m_mappedCount);
+    std::copy(m_mappedCues, m_mappedCues + m_mappedCount, m_cues.begin());
+    m_tokens.resize(m_mappedTokenCount);
+    std::copy(m_mappedTokens, m_mappedTokens + m_mappedTokenCount, m_tokens.begin());
+    m_text = QString(m_text.constData(), m_text.size());
+
+    m_mapping.reset();
+    m_mappedCues = nullptr;
+    m_mappedCount = 0;
+    m_mappedTokens = nullptr;
+    m_mappedTokenCount = 0;
+}
+
+void CueTable::reserve(int cues, int textLength)
+{
+    detach();
+    m_cues.reserve(cues);
+    m_tokens.reserve(textLength / 5);
+    m_text.reserve(textLength);
+}
+
+void CueTable::append(qint64 start, qint64 end, const QString &text)
+{
+    append(start, end, text.constData(), text.size());
+}
+
+void CueTable::append(qint64 start, qint64 end, const QChar *text, int length)
+{
+    detach();
+
+    Cue cue;
+    cue.start = qint32(qBound<qint64>(0, start, std::numeric_limits<qint32>::max()));
+    cue.end = qint32(qBound<qint64>(cue.start, end, std::numeric_limits<qint32>::max()));
+    cue.textOffset = m_text.size();
+    cue.lineCount = length > 0 ? 1 : 0;
+
+    //lines are stored '\n'-separated regardless of the source line endings
+    for (int i = 0; i < length; ++i)
+    {
+        if (text[i] == QLatin1Char('\r'))
+        {
+            continue;
+        }
+        if (text[i] == QLatin1Char('\n'))
+        {
+            ++cue.lineCount;
+        }
+        m_text += text[i];
+    }
+
+    cue.textLength = m_text.size() - cue.textOffset;
+
+    cue.firstToken = m_tokens.size();
+    SubtitleWords::tokenize(m_text.constData() + cue.textOffset, cue.textLength, &m_tokens, cue.textOffset);
+    cue.tokenCount = m_tokens.size() - cue.firstToken;
+
+    m_cues.push_back(cue);
+    m_maxEnd.push_back(m_maxEnd.isEmpty() ? cue.end : qMax(m_maxEnd.last(), cue.end));
+}
+
+void CueTable::sort()
+{
+    detach();
+
+    //cues are nearly always in order already
+    if (std::is_sorted(m_cues.cbegin(), m_cues.cend(),
+                       [](const Cue &a, const Cue &b) { return a.start < b.start; }))
+    {
+        return;
+    }
+
+    std::stable_sort(m_cues.begin(), m_cues.end(),
+                     [](const Cue &a, const Cue &b) { return a.start < b.start; });
+    updateMaxEnd();
+}
+
+void CueTable::updateMaxEnd()
+{
+    m_maxEnd.resize(size());
+    qint32 maxEnd = std::numeric_limits<qint32>::min();
+    for (int i = 0; i < size(); ++i)
+    {
+        maxEnd = qMax(maxEnd, at(i).end);
+        m_maxEnd[i] = maxEnd;
+    }
+}
+
+void CueTable::squeeze()
+{
+    detach();
+    m_cues.squeeze();
+    m_tokens.squeeze();
+    m_maxEnd.squeeze();
+    m_text.squeeze();
+}
+
+QString CueTable::text(int cue) const
+{
+    return textRef(cue).toString();
+}
+
+QStringRef CueTable::textRef(int cue) const
+{
+    if (cue < 0 || cue >= size())
+    {
+        return QStringRef();
+    }
+
+    return m_text.midRef(at(cue).textOffset, at(cue).textLength);
+}
+
+QStringRef CueTable::tokenRef(int cue, int token) const
+{
+    if (cue < 0 || cue >= size() || token < 0 || token >= at(cue).tokenCount)
+    {
+        return QStringRef();
+    }
+
+    const Token &span = tokenData()[at(cue).firstToken + token];
+    return m_text.midRef(span.offset, span.length);
+}
+
+int CueTable::indexAtOrBefore(qint64 position) const
+{
+    const Cue *begin = constData();
+    const Cue *it = std::upper_bound(begin, begin + size(), position,
+                                     [](qint64 pos, const Cue &cue) { return pos < cue.start; });
+
+    return int(it - begin) - 1;
+}
+
+int CueTable::activeAtOrBefore(int cue, qint64 position) const
+{
+    //the latest start still running wins; once no cue up to i ends at or
+    //after position, nothing earlier can be running either
+    for (int i = cue; i >= 0 && m_maxEnd.at(i) >= position; --i)
+    {
+        if (at(i).end >= position)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+int CueTable::find(qint64 position, int hint) const
+{
+    //playback mostly moves forward, so the last cue starting at or before
+    //position is usually the last hit or its successor
+    int last = -1;
+    if (hint >= 0 && hint < size() && at(hint).start <= position)
+    {
+        if (hint + 1 == size() || at(hint + 1).start > position)
+        {
+            last = hint;
+        }
+        else if (hint + 2 == size() || at(hint + 2).start > position)
+        {
+            last = hint + 1;
+        }
+    }
+
+    if (last < 0)
+    {
+        last = indexAtOrBefore(position);
+    }
+
+    return activeAtOrBefore(last, position);
+}
+
+qint64 CueTable::nextBoundary(qint64 position) const
+{
+    const int last = indexAtOrBefore(position);
+    qint64 boundary = std::numeric_limits<qint64>::max();
+
+    if (last + 1 < size())
+    {
+        boundary = at(last + 1).start;
+    }
+
+    //the shown cue stays visible up to and including its end time; an
+    //earlier cue still running may take over after it
+    const int cue = activeAtOrBefore(last, position);
+    if (cue >= 0)
+    {
+        boundary = qMin(boundary, qint64(at(cue).end) + 1);
+    }
+
+    return boundary;
+}
+
+qint64 CueTable::parseTimestamp(const QStringRef &timestamp, bool *ok)
+{
+    //[hh:]mm:ss[,.]mmm
+    qint64 fields[4] = {0, 0, 0, 0};
+    int count = 0;
+    int colons = 0;
+    int digits = 0;
+    int fractionDigits = 0;
+    bool valid = !timestamp.isEmpty();
+
+    for (QChar c : timestamp)
+    {
+        if (c.isDigit())
+        {
+            fields[count] = fields[count] * 10 + c.digitValue();
+            ++digits;
+            if (count == 3)
+            {
+                ++fractionDigits;
+            }
+        }
+        else if ((c == ':' || c == ',' || c == '.') && digits > 0 && count < 3)
+        {
+            //only the last separator may introduce the fraction
+            if (c != ':' && count == 0)
+            {
+                valid = false;
+                break;
+            }
+
+            ++count;
+            digits = 0;
+            if (c == ':')
+            {
+                ++colons;
+            }
+            else
+            {
+                count = 3;
+            }
+        }
+        else
+        {
+            //trailing cue settings (e.g. "X1:...") end the timestamp
+            if (c.isSpace())
+            {
+                break;
+            }
+            valid = false;
+            break;
+        }
+    }
+
+    if (!valid || colons == 0 || colons > 2 || (colons == 1 && count != 3))
+    {
+        if (ok)
+        {
+            *ok = false;
+        }
+        return 0;
+    }
+
+    //mm:ss,mmm without hours shifts the fields
+    qint64 hours = fields[0];
+    qint64 minutes = fields[1];
+    qint64 seconds = fields[2];
+    if (colons == 1)
+    {
+        hours = 0;
+        minutes = fields[0];
+        seconds = fields[1];
+    }
+
+    qint64 millis = fields[3];
+    while (fractionDigits > 3)
+    {
+        millis /= 10;
+        --fractionDigits;
+    }
+    while (fractionDigits > 0 && fractionDigits < 3)
+    {
+        millis *= 10;
+        ++fractionDigits;
+    }
+
+    if (ok)
+    {
+        *ok = true;
+    }
+
+    return (hours * 3600000) + (minutes * 60000) + (seconds * 1000) + millis;
+}
+
+QString CueTable::formatTimestamp(qint64 milliseconds)
+{
+    return QString("%1:%2:%3,%4")
+            .arg(milliseconds / 3600000, 2, 10, QChar('0'))
+            .arg((milliseconds / 60000) % 60, 2, 10, QChar('0'))
+            .arg((milliseconds / 1000) % 60, 2, 10, QChar('0'))
+            .arg(milliseconds % 1000, 3, 10, QChar('0'));
+}
+
+QString CueTable::formatTiming(const Cue &cue)
+{
+    return formatTimestamp(cue.start) + " --> " + formatTimestamp(cue.end);
+}
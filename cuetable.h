@@ -0,0 +1,92 @@
+#ifndef CUETABLE_H
+#define CUETABLE_H
+
+#include "subtitlewords.h"
+
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+//Compact, start-sorted table of subtitle cues.
+//Timings are parsed once at load; lookups by playback position are
+//O(log n), or O(1) when advancing from the previous hit. Word spans
+//are found once per cue at append() time, so nothing downstream has to
+//re-scan cue text to find words.
+//When cues overlap, the one that started last is shown (on equal starts
+//the later one in the file); an earlier cue that is still running is
+//shown again once the later one ends.
+//A table can also be a read-only view into a memory-mapped cue cache
+//file; it is copied into owned storage on the first modification.
+class CueTable
+{
+public:
+    struct Cue
+    {
+        qint32 start;       //ms
+        qint32 end;         //ms, inclusive
+        qint32 textOffset;  //into the shared text buffer
+        qint32 textLength;
+        qint32 lineCount;
+        qint32 firstToken;  //into the shared token buffer
+        qint32 tokenCount;
+    };
+
+    //a word of a cue; offset is into the shared text buffer
+    typedef SubtitleWords::Span Token;
+
+    void reserve(int cues, int textLength);
+    void append(qint64 start, qint64 end, const QString &text);
+    void append(qint64 start, qint64 end, const QChar *text, int length);
+    void sort();
+    void squeeze();
+
+    int size() const { return m_mapping ? m_mappedCount : m_cues.size(); }
+    bool isEmpty() const { return size() == 0; }
+    const Cue &at(int cue) const { return constData()[cue]; }
+
+    //raw storage, for serialising the table
+    const Cue *constData() const { return m_mapping ? m_mappedCues : m_cues.constData(); }
+    const Token *tokenData() const { return m_mapping ? m_mappedTokens : m_tokens.constData(); }
+    int tokenBufferSize() const { return m_mapping ? m_mappedTokenCount : m_tokens.size(); }
+    const QString &textBuffer() const { return m_text; }
+    //mapping owns the mapped region; it is released with the last table sharing it
+    static CueTable fromMapping(const QSharedPointer<const uchar> &mapping, const Cue *cues, int count,
+                                const Token *tokens, int tokenCount, const QChar *text, int textLength);
+
+    QString text(int cue) const;
+    QStringRef textRef(int cue) const;
+
+    int tokenCount(int cue) const { return at(cue).tokenCount; }
+    QStringRef tokenRef(int cue, int token) const;
+
+    //the cue shown at position, or -1
+    int find(qint64 position, int hint = -1) const;
+    //the last cue starting at or before position, shown or not
+    int indexAtOrBefore(qint64 position) const;
+    qint64 nextBoundary(qint64 position) const;
+
+    static qint64 parseTimestamp(const QStringRef &timestamp, bool *ok = nullptr);
+    static QString formatTimestamp(qint64 milliseconds);
+    static QString formatTiming(const Cue &cue);
+
+private:
+    void detach();
+    void updateMaxEnd();
+    int activeAtOrBefore(int cue, qint64 position) const;
+
+    QVector<Cue> m_cues;
+    QVector<Token> m_tokens;
+    QString m_text;
+    //latest end among cues [0, i]; bounds the backward scan for a long,
+    //earlier cue that is still running
+    QVector<qint32> m_maxEnd;
+
+    //set while the table is a view into a mapped cache file
+    QSharedPointer<const uchar> m_mapping;
+    const Cue *m_mappedCues = nullptr;
+    int m_mappedCount = 0;
+    const Token *m_mappedTokens = nullptr;
+    int m_mappedTokenCount = 0;
+};
+
+#endif // CUETABLE_H
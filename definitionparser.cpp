@@ -0,0 +1,609 @@
+#include "definitionparser.h"
+
+#include <QUrl>
+#include <QVarLengthArray>
+#include <cstring>
+
+void DictionaryEntry::clear()
+{
+    arena.resize(0);
+    word = Span();
+    lexicalEntries.resize(0);
+    pronunciations.resize(0);
+    senses.resize(0);
+    items.resize(0);
+}
+
+QString DictionaryEntry::text(const Span &span) const
+{
+    return span.isNull() ? QString() : QString::fromUtf8(arena.constData() + span.offset, span.length);
+}
+
+namespace {
+
+enum Key : quint8
+{
+    Other,
+    Results,
+    Id,
+    LexicalEntries,
+    LexicalCategory,
+    Text,
+    Entries,
+    Pronunciations,
+    AudioFile,
+    Senses,
+    Definitions,
+    CrossReferenceMarkers,
+    Examples,
+    Synonyms
+};
+
+Key keyFor(const char *name, int length)
+{
+    struct Name { const char *name; Key key; };
+    static const Name names[] = {
+        {"results", Results}, {"id", Id}, {"lexicalEntries", LexicalEntries},
+        {"lexicalCategory", LexicalCategory}, {"text", Text}, {"entries", Entries},
+        {"pronunciations", Pronunciations}, {"audioFile", AudioFile}, {"senses", Senses},
+        {"definitions", Definitions}, {"crossReferenceMarkers", CrossReferenceMarkers},
+        {"examples", Examples}, {"synonyms", Synonyms}
+    };
+
+    for (const Name &n : names)
+    {
+        if (int(std::strlen(n.name)) == length && std::memcmp(n.name, name, length) == 0)
+        {
+            return n.key;
+        }
+    }
+    return Other;
+}
+
+//member key plus, once inside its array, the element index
+struct Frame
+{
+    Key key;
+    int index;
+};
+
+class Walker
+{
+public:
+    Walker(const QByteArray &json, DictionaryEntry *entry)
+        : m_p(json.constData())
+        , m_end(json.constData() + json.size())
+        , m_entry(entry)
+    {
+    }
+
+    bool run()
+    {
+        skipSpace();
+        if (!value(0))
+        {
+            return false;
+        }
+        skipSpace();
+        return m_p == m_end;
+    }
+
+private:
+    static const int MaxDepth = 64;
+
+    void skipSpace()
+    {
+        while (m_p < m_end && (*m_p == ' ' || *m_p == '\n' || *m_p == '\r' || *m_p == '\t'))
+        {
+            ++m_p;
+        }
+    }
+
+    //path helpers; the response nests as
+    //results[0].lexicalEntries[i].entries[0].senses[j].<field>
+    bool is(int depth, Key key, int index = -2) const
+    {
+        return m_path.size() > depth && m_path.at(depth).key == key
+                && (index == -2 || m_path.at(depth).index == index);
+    }
+
+    bool inLexicalEntry() const
+    {
+        return is(0, Results, 0) && is(1, LexicalEntries) && m_path.at(1).index >= 0;
+    }
+
+    bool inSense() const
+    {
+        return inLexicalEntry() && is(2, Entries, 0) && is(3, Senses)
+                && m_path.at(3).index >= 0 && m_path.at(3).index < DefinitionParser::MaxSenses;
+    }
+
+    void objectStarted()
+    {
+        if (m_path.size() == 2 && inLexicalEntry())
+        {
+            m_entry->lexicalEntries.push_back(DictionaryEntry::LexicalEntry());
+        }
+        else if (m_path.size() == 4 && inSense())
+        {
+            m_entry->senses.push_back({DictionaryEntry::Span(), m_entry->lexicalEntries.size() - 1});
+        }
+    }
+
+    void stringFound(const DictionaryEntry::Span &span)
+    {
+        const int depth = m_path.size();
+
+        if (depth == 2 && is(0, Results, 0) && is(1, Id))
+        {
+            m_entry->word = span;
+        }
+        else if (depth == 4 && inLexicalEntry() && is(2, LexicalCategory) && is(3, Text))
+        {
+            m_entry->lexicalEntries.last().category = span;
+        }
+        else if (depth == 5 && inLexicalEntry() && is(2, Entries, 0) && is(3, Pronunciations) && is(4, AudioFile))
+        {
+            m_entry->pronunciations.push_back({span, m_entry->lexicalEntries.size() - 1});
+        }
+        else if (inSense() && !m_entry->senses.isEmpty())
+        {
+            const int sense = m_entry->senses.size() - 1;
+            if (depth == 5 && is(4, Definitions, 0))
+            {
+                m_entry->senses.last().definition = span;
+            }
+            else if (depth == 5 && is(4, CrossReferenceMarkers) && m_path.at(4).index >= 0)
+            {
+                m_entry->items.push_back({span, sense, DictionaryEntry::CrossReference});
+            }
+            else if (depth == 6 && is(4, Examples) && m_path.at(4).index >= 0 && is(5, Text))
+            {
+                m_entry->items.push_back({span, sense, DictionaryEntry::Example});
+            }
+            else if (depth == 6 && is(4, Synonyms) && m_path.at(4).index >= 0 && is(5, Text))
+            {
+                m_entry->items.push_back({span, sense, DictionaryEntry::Synonym});
+            }
+        }
+    }
+
+    bool value(int depth)
+    {
+        if (m_p >= m_end || depth > MaxDepth)
+        {
+            return false;
+        }
+
+        switch (*m_p)
+        {
+        case '{':
+            return object(depth);
+        case '[':
+            return array(depth);
+        case '"':
+        {
+            DictionaryEntry::Span span;
+            if (!string(&span))
+            {
+                return false;
+            }
+            stringFound(span);
+            return true;
+        }
+        default:
+            return literal();
+        }
+    }
+
+    bool object(int depth)
+    {
+        ++m_p;
+        objectStarted();
+
+        skipSpace();
+        if (m_p < m_end && *m_p == '}')
+        {
+            ++m_p;
+            return true;
+        }
+
+        while (m_p < m_end)
+        {
+            skipSpace();
+            const char *keyBegin = nullptr;
+            int keyLength = 0;
+            if (!rawKey(&keyBegin, &keyLength))
+            {
+                return false;
+            }
+
+            skipSpace();
+            if (m_p >= m_end || *m_p != ':')
+            {
+                return false;
+            }
+            ++m_p;
+            skipSpace();
+
+            m_path.push_back({keyFor(keyBegin, keyLength), -1});
+            const bool ok = value(depth + 1);
+            m_path.pop_back();
+            if (!ok)
+            {
+                return false;
+            }
+
+            skipSpace();
+            if (m_p < m_end && *m_p == ',')
+            {
+                ++m_p;
+                continue;
+            }
+            if (m_p < m_end && *m_p == '}')
+            {
+                ++m_p;
+                return true;
+            }
+            return false;
+        }
+
+        return false;
+    }
+
+    bool array(int depth)
+    {
+        ++m_p;
+
+        //nested arrays get an anonymous frame of their own
+        const bool anonymous = m_path.isEmpty() || m_path.last().index >= 0;
+        if (anonymous)
+        {
+            m_path.push_back({Other, -1});
+        }
+
+        skipSpace();
+        bool ok = true;
+        if (m_p < m_end && *m_p == ']')
+        {
+            ++m_p;
+        }
+        else
+        {
+            for (int index = 0; ; ++index)
+            {
+                m_path.last().index = index;
+                skipSpace();
+                if (!value(depth + 1))
+                {
+                    ok = false;
+                    break;
+                }
+
+                skipSpace();
+                if (m_p < m_end && *m_p == ',')
+                {
+                    ++m_p;
+                    continue;
+                }
+                if (m_p < m_end && *m_p == ']')
+                {
+                    ++m_p;
+                    break;
+                }
+                ok = false;
+                break;
+            }
+        }
+
+        if (anonymous)
+        {
+            m_path.pop_back();
+        }
+        else
+        {
+            m_path.last().index = -1;
+        }
+        return ok;
+    }
+
+    bool rawKey(const char **begin, int *length)
+    {
+        if (m_p >= m_end || *m_p != '"')
+        {
+            return false;
+        }
+
+        *begin = ++m_p;
+        while (m_p < m_end && *m_p != '"')
+        {
+            //escaped keys are never ones we look for
+            if (*m_p == '\\' && ++m_p >= m_end)
+            {
+                return false;
+            }
+            ++m_p;
+        }
+
+        if (m_p >= m_end)
+        {
+            return false;
+        }
+
+        *length = int(m_p - *begin);
+        ++m_p;
+        return true;
+    }
+
+    void appendUtf8(uint code)
+    {
+        QByteArray &arena = m_entry->arena;
+        if (code < 0x80)
+        {
+            arena.append(char(code));
+        }
+        else if (code < 0x800)
+        {
+            arena.append(char(0xC0 | (code >> 6)));
+            arena.append(char(0x80 | (code & 0x3F)));
+        }
+        else if (code < 0x10000)
+        {
+            arena.append(char(0xE0 | (code >> 12)));
+            arena.append(char(0x80 | ((code >> 6) & 0x3F)));
+            arena.append(char(0x80 | (code & 0x3F)));
+        }
+        else
+        {
+            arena.append(char(0xF0 | (code >> 18)));
+            arena.append(char(0x80 | ((code >> 12) & 0x3F)));
+            arena.append(char(0x80 | ((code >> 6) & 0x3F)));
+            arena.append(char(0x80 | (code & 0x3F)));
+        }
+    }
+
+    bool hex4(uint *code)
+    {
+        if (m_end - m_p < 4)
+        {
+            return false;
+        }
+
+        uint value = 0;
+        for (int i = 0; i < 4; ++i, ++m_p)
+        {
+            const char c = *m_p;
+            value <<= 4;
+            if (c >= '0' && c <= '9')
+                value |= uint(c - '0');
+            else if (c >= 'a' && c <= 'f')
+                value |= uint(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F')
+                value |= uint(c - 'A' + 10);
+            else
+                return false;
+        }
+
+        *code = value;
+        return true;
+    }
+
+    //unescapes straight into the arena
+    bool string(DictionaryEntry::Span *span)
+    {
+        ++m_p;
+        QByteArray &arena = m_entry->arena;
+        span->offset = arena.size();
+
+        while (m_p < m_end && *m_p != '"')
+        {
+            //copy unescaped runs in one go
+            const char *run = m_p;
+            while (m_p < m_end && *m_p != '"' && *m_p != '\\')
+            {
+                ++m_p;
+            }
+            arena.append(run, int(m_p - run));
+
+            if (m_p >= m_end || *m_p == '"')
+            {
+                break;
+            }
+
+            if (++m_p >= m_end)
+            {
+                return false;
+            }
+
+            const char escaped = *m_p++;
+            switch (escaped)
+            {
+            case '"': arena.append('"'); break;
+            case '\\': arena.append('\\'); break;
+            case '/': arena.append('/'); break;
+            case 'b': arena.append('\b'); break;
+            case 'f': arena.append('\f'); break;
+            case 'n': arena.append('\n'); break;
+            case 'r': arena.append('\r'); break;
+            case 't': arena.append('\t'); break;
+            case 'u':
+            {
+                uint code = 0;
+                if (!hex4(&code))
+                {
+                    return false;
+                }
+
+                //surrogate pair
+                if (code >= 0xD800 && code < 0xDC00 && m_end - m_p >= 6 && m_p[0] == '\\' && m_p[1] == 'u')
+                {
+                    m_p += 2;
+                    uint low = 0;
+                    if (!hex4(&low) || low < 0xDC00 || low >= 0xE000)
+                    {
+                        return false;
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(code);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+
+        if (m_p >= m_end)
+        {
+            return false;
+        }
+
+        ++m_p;
+        span->length = arena.size() - span->offset;
+        return true;
+    }
+
+    bool literal()
+    {
+        const char *begin = m_p;
+        while (m_p < m_end && *m_p != ',' && *m_p != '}' && *m_p != ']'
+               && *m_p != ' ' && *m_p != '\n' && *m_p != '\r' && *m_p != '\t')
+        {
+            ++m_p;
+        }
+        return m_p > begin;
+    }
+
+    const char *m_p;
+    const char *m_end;
+    DictionaryEntry *m_entry;
+    QVarLengthArray<Frame, 16> m_path;
+};
+
+void appendEscaped(QByteArray &out, const DictionaryEntry &entry, const DictionaryEntry::Span &span)
+{
+    if (span.isNull())
+    {
+        return;
+    }
+
+    const char *p = entry.arena.constData() + span.offset;
+    const char *end = p + span.length;
+    for (; p < end; ++p)
+    {
+        switch (*p)
+        {
+        case '<': out.append("&lt;"); break;
+        case '>': out.append("&gt;"); break;
+        case '&': out.append("&amp;"); break;
+        case '\'': out.append("&#39;"); break;
+        default: out.append(*p);
+        }
+    }
+}
+
+} // namespace
+
+bool DefinitionParser::parse(const QByteArray &json, DictionaryEntry *entry)
+{
+    entry->clear();
+    entry->arena.reserve(json.size());
+
+    return Walker(json, entry).run() && !entry->word.isNull();
+}
+
+QString DefinitionParser::renderHtml(const DictionaryEntry &entry)
+{
+    //tags roughly double the text, so one reservation covers the whole page
+    QByteArray out;
+    out.reserve(entry.arena.size() * 2 + 512);
+
+    out.append("<p style='color:red'><b>");
+    appendEscaped(out, entry, entry.word);
+    out.append("</b></p><br>");
+
+    int pronunciation = 0;
+    int sense = 0;
+    int item = 0;
+
+    for (int lex = 0; lex < entry.lexicalEntries.size(); ++lex)
+    {
+        //lexical category
+        out.append("<i>");
+        appendEscaped(out, entry, entry.lexicalEntries.at(lex).category);
+        out.append("</i><br><br>");
+
+        //pronunciation
+        for (; pronunciation < entry.pronunciations.size()
+             && entry.pronunciations.at(pronunciation).lexicalEntry == lex; ++pronunciation)
+        {
+            out.append("<a href='");
+            appendEscaped(out, entry, entry.pronunciations.at(pronunciation).audioFile);
+            out.append("'>Pronunciation</a><br><br>");
+        }
+
+        for (; sense < entry.senses.size() && entry.senses.at(sense).lexicalEntry == lex; ++sense)
+        {
+            //definition
+            out.append("<b>");
+            appendEscaped(out, entry, entry.senses.at(sense).definition);
+            out.append("</b><br>");
+
+            //items are stored in document order; group them by kind
+            const int firstItem = item;
+            while (item < entry.items.size() && entry.items.at(item).sense == sense)
+            {
+                ++item;
+            }
+
+            //cross-references
+            for (int i = firstItem; i < item; ++i)
+            {
+                if (entry.items.at(i).kind == DictionaryEntry::CrossReference)
+                {
+                    out.append("<b>");
+                    appendEscaped(out, entry, entry.items.at(i).text);
+                    out.append("</b><br>");
+                }
+            }
+
+            //examples
+            for (int i = firstItem; i < item; ++i)
+            {
+                if (entry.items.at(i).kind == DictionaryEntry::Example)
+                {
+                    out.append("<ul><li>Example: ");
+                    appendEscaped(out, entry, entry.items.at(i).text);
+                    out.append("</ul>");
+                }
+            }
+
+            //synonyms
+            bool firstSynonym = true;
+            for (int i = firstItem; i < item; ++i)
+            {
+                if (entry.items.at(i).kind == DictionaryEntry::Synonym)
+                {
+                    out.append(firstSynonym ? "<ul><li>Synonyms: " : ", ");
+                    appendEscaped(out, entry, entry.items.at(i).text);
+                    firstSynonym = false;
+                }
+            }
+            if (!firstSynonym)
+            {
+                out.append("</ul>");
+            }
+        }
+
+        out.append("<hr><br>");
+    }
+
+    out.append("<p align='right'><a href='https://www.google.com/search?dictcorpus=en-gb&hl=en&forcedict=");
+    const QByteArray word = QUrl::toPercentEncoding(entry.text(entry.word));
+    out.append(word);
+    out.append("&q=define%20");
+    out.append(word);
+    out.append("'>View More (Google Search)</a></p>");
+
+    return QString::fromUtf8(out);
+}
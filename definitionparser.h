@@ -0,0 +1,76 @@
+#ifndef DEFINITIONPARSER_H
+#define DEFINITIONPARSER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+//Fields of an Oxford "entries" response that the definition panel shows.
+//All strings live unescaped in one UTF-8 arena and are referenced by
+//span; clear() keeps the capacity so a parser can reuse it per lookup.
+struct DictionaryEntry
+{
+    struct Span
+    {
+        qint32 offset = 0;
+        qint32 length = -1;
+
+        bool isNull() const { return length < 0; }
+    };
+
+    enum ItemKind : quint8
+    {
+        CrossReference,
+        Example,
+        Synonym
+    };
+
+    struct LexicalEntry
+    {
+        Span category;
+    };
+
+    struct Pronunciation
+    {
+        Span audioFile;
+        qint32 lexicalEntry;
+    };
+
+    struct Sense
+    {
+        Span definition;
+        qint32 lexicalEntry;
+    };
+
+    struct Item
+    {
+        Span text;
+        qint32 sense;
+        ItemKind kind;
+    };
+
+    QByteArray arena;
+    Span word;
+    QVector<LexicalEntry> lexicalEntries;
+    QVector<Pronunciation> pronunciations;
+    QVector<Sense> senses;
+    QVector<Item> items;
+
+    void clear();
+    QString text(const Span &span) const;
+};
+
+//Single-pass extractor for dictionary responses.
+//Walks the JSON bytes once without building a document tree, keeping only
+//the paths rendered in the panel (first entry, first two senses per
+//lexical entry), and renders the panel HTML into one pre-sized buffer.
+class DefinitionParser
+{
+public:
+    static const int MaxSenses = 2;
+
+    static bool parse(const QByteArray &json, DictionaryEntry *entry);
+    static QString renderHtml(const DictionaryEntry &entry);
+};
+
+#endif // DEFINITIONPARSER_H
@@ -0,0 +1,151 @@
+#include "definitionprefetcher.h"
+
+#include "dictionarybackend.h"
+#include "dictionarycache.h"
+#include "dictionaryclient.h"
+#include "lemmatizer.h"
+#include "subtitlewords.h"
+
+#include <QMediaPlayer>
+#include <algorithm>
+
+DefinitionPrefetcher::DefinitionPrefetcher(QMediaPlayer *player, DictionaryCache *cache, DictionaryClient *client,
+                                           const QString &language, QObject *parent)
+    : QObject(parent)
+    , m_player(player)
+    , m_cache(cache)
+    , m_client(client)
+    , m_language(language)
+{
+    m_pump.setInterval(250);
+    connect(&m_pump, &QTimer::timeout, this, &DefinitionPrefetcher::dispatch);
+    connect(m_client, &DictionaryClient::finished, this, &DefinitionPrefetcher::fetched);
+
+    //positionChanged covers normal progress and seeks alike
+    connect(m_player, &QMediaPlayer::positionChanged, this, &DefinitionPrefetcher::refill);
+    connect(m_player, &QMediaPlayer::playbackRateChanged, this, &DefinitionPrefetcher::refill);
+}
+
+void DefinitionPrefetcher::setCueTable(const CueTable &cues)
+{
+    m_cues = cues;
+    refill();
+}
+
+void DefinitionPrefetcher::setBackend(DictionaryBackend *backend)
+{
+    m_backend = backend;
+}
+
+void DefinitionPrefetcher::setLookahead(int seconds)
+{
+    m_lookahead = seconds;
+}
+
+void DefinitionPrefetcher::setMaxInFlight(int requests)
+{
+    m_maxInFlight = qMax(1, requests);
+}
+
+void DefinitionPrefetcher::setInterval(int milliseconds)
+{
+    m_pump.setInterval(milliseconds);
+}
+
+bool DefinitionPrefetcher::isKnown(const QString &word) const
+{
+    return SubtitleWords::isStopWord(word)
+            || m_inFlight.contains(word)
+            || m_unavailable.contains(word)
+            || m_cache->contains(m_language, word)
+            || (m_backend && m_backend->lookup(m_language, word, nullptr));
+}
+
+void DefinitionPrefetcher::refill()
+{
+    //rebuilt from scratch each time so words behind a seek are dropped
+    m_queue.clear();
+
+    if (m_cues.isEmpty() || m_player->state() == QMediaPlayer::StoppedState)
+    {
+        m_pump.stop();
+        return;
+    }
+
+    const qint64 position = m_player->position();
+    const qint64 window = qint64(m_lookahead * 1000 * qMax<qreal>(1.0, m_player->playbackRate()));
+
+    QSet<QString> queued;
+    for (int i = qMax(0, m_cues.indexAtOrBefore(position)); i < m_cues.size() && m_cues.at(i).start <= position + window; ++i)
+    {
+        if (m_cues.at(i).end < position)
+        {
+            continue;
+        }
+
+        for (const QString &word : SubtitleWords::wordsOf(m_cues, i))
+        {
+            if (SubtitleWords::isStopWord(word))
+            {
+                continue;
+            }
+
+            //requests and cache entries are per lemma, like the lookups they
+            //warm; once a guessed lemma turns out missing, the next key gets its turn
+            const QStringList keys = Lemmatizer::keys(word);
+            const auto next = std::find_if(keys.begin(), keys.end(), [this](const QString &key)
+            {
+                return !m_unavailable.contains(key);
+            });
+            if (next != keys.end() && !queued.contains(*next) && !isKnown(*next))
+            {
+                queued.insert(*next);
+                m_queue.push_back(*next);
+            }
+        }
+    }
+
+    if (!m_queue.isEmpty() && !m_pump.isActive())
+    {
+        dispatch();
+        m_pump.start();
+    }
+}
+
+void DefinitionPrefetcher::dispatch()
+{
+    if (m_queue.isEmpty())
+    {
+        m_pump.stop();
+        return;
+    }
+
+    //one request per tick keeps us under the API rate limit
+    if (m_inFlight.size() >= m_maxInFlight)
+    {
+        return;
+    }
+
+    const QString word = m_queue.takeFirst();
+    if (isKnown(word))
+    {
+        return;
+    }
+
+    m_inFlight.insert(word);
+    m_client->fetch(m_language, word, DictionaryClient::Prefetch);
+}
+
+void DefinitionPrefetcher::fetched(const QString &language, const QString &word, QNetworkReply::NetworkError error)
+{
+    //the client stores answers in the cache itself
+    if (language != m_language || !m_inFlight.remove(word))
+    {
+        return;
+    }
+
+    if (error == QNetworkReply::ContentNotFoundError)
+    {
+        m_unavailable.insert(word);
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef DEFINITIONPREFETCHER_H
+#define DEFINITIONPREFETCHER_H
+
+#include "cuetable.h"
+
+#include <QNetworkReply>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+QT_BEGIN_NAMESPACE
+class QMediaPlayer;
+QT_END_NAMESPACE
+
+class DictionaryBackend;
+class DictionaryCache;
+class DictionaryClient;
+
+//Warms the dictionary cache with words from the upcoming cues.
+//The lookahead window (in media time) scales with the playback rate and
+//is re-evaluated on every position update, so seeks simply re-aim it.
+//Requests go out at most m_maxInFlight at a time and no faster than one
+//per m_interval ms, at prefetch priority on the shared client.
+class DefinitionPrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    DefinitionPrefetcher(QMediaPlayer *player, DictionaryCache *cache, DictionaryClient *client,
+                         const QString &language, QObject *parent = nullptr);
+
+    void setCueTable(const CueTable &cues);
+    void setBackend(DictionaryBackend *backend);
+    void setLookahead(int seconds);
+    void setMaxInFlight(int requests);
+    void setInterval(int milliseconds);
+
+private slots:
+    void refill();
+    void dispatch();
+    void fetched(const QString &language, const QString &word, QNetworkReply::NetworkError error);
+
+private:
+    bool isKnown(const QString &word) const;
+
+    QMediaPlayer *m_player = nullptr;
+    DictionaryCache *m_cache = nullptr;
+    DictionaryBackend *m_backend = nullptr;
+    DictionaryClient *m_client = nullptr;
+    QString m_language;
+
+    CueTable m_cues;
+    QStringList m_queue;
+    QSet<QString> m_inFlight;
+    QSet<QString> m_unavailable;
+    QTimer m_pump;
+
+    int m_lookahead = 30;
+    int m_maxInFlight = 2;
+};
+
+#endif // DEFINITIONPREFETCHER_H
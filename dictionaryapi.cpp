@@ -0,0 +1,37 @@
+#include "dictionaryapi.h"
+
+static const QByteArray app_id = "a74a5872";
+static const QByteArray app_key = "46564d304f6f015945afbc97336f4f3c";
+
+//set once at startup, before any request is built
+static QUrl base_url = DictionaryApi::defaultBaseUrl();
+
+QUrl DictionaryApi::defaultBaseUrl()
+{
+    return QUrl("https://od-api.oxforddictionaries.com/api/v2/");
+}
+
+QUrl DictionaryApi::baseUrl()
+{
+    return base_url;
+}
+
+void DictionaryApi::setBaseUrl(const QUrl &url)
+{
+    //resolved() drops the last path segment unless it ends in a slash
+    base_url = url;
+    if (!base_url.path().endsWith('/'))
+    {
+        base_url.setPath(base_url.path() + '/');
+    }
+}
+
+QNetworkRequest DictionaryApi::entriesRequest(const QString &language, const QString &word)
+{
+    QString endpoint = "entries";
+
+    QNetworkRequest request(base_url.resolved(QUrl(endpoint + "/" + language + "/" + QUrl::toPercentEncoding(word))));
+    request.setRawHeader("app_id", app_id);
+    request.setRawHeader("app_key", app_key);
+    return request;
+}
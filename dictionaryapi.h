@@ -0,0 +1,20 @@
+#ifndef DICTIONARYAPI_H
+#define DICTIONARYAPI_H
+
+#include <QNetworkRequest>
+#include <QString>
+#include <QUrl>
+
+//Oxford Dictionaries API endpoint and credentials, shared by every
+//component that talks to the online dictionary.
+//The base URL can be pointed at a local stand-in for offline testing.
+namespace DictionaryApi
+{
+    QUrl defaultBaseUrl();
+    QUrl baseUrl();
+    void setBaseUrl(const QUrl &url);
+
+    QNetworkRequest entriesRequest(const QString &language, const QString &word);
+}
+
+#endif // DICTIONARYAPI_H
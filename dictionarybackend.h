@@ -0,0 +1,18 @@
+#ifndef DICTIONARYBACKEND_H
+#define DICTIONARYBACKEND_H
+
+#include <QByteArray>
+#include <QString>
+
+//Common interface for local definition sources.
+//Answers use the Oxford Dictionaries "entries" JSON layout so every
+//source renders through the same path as the online API.
+class DictionaryBackend
+{
+public:
+    virtual ~DictionaryBackend() = default;
+
+    virtual bool lookup(const QString &language, const QString &word, QByteArray *answer) = 0;
+};
+
+#endif // DICTIONARYBACKEND_H
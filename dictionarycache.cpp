@@ -0,0 +1,286 @@
+#include "dictionarycache.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QVector>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+
+static const quint32 CACHE_MAGIC = 0x44494354; //"DICT"
+static const quint32 CACHE_VERSION = 1;
+
+//flush to disk after this many new entries, besides on destruction
+static const int SAVE_INTERVAL = 32;
+
+DictionaryCache::DictionaryCache(const QString &fileName, qint64 maxBytes, qint64 ttlSeconds)
+    : m_fileName(fileName)
+    , m_maxBytes(maxBytes)
+    , m_ttlSeconds(ttlSeconds)
+{
+    load();
+}
+
+DictionaryCache::~DictionaryCache()
+{
+    //save() waits for a background write still in progress
+    save();
+}
+
+QString DictionaryCache::defaultFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/dictionary.cache";
+}
+
+QString DictionaryCache::key(const QString &language, const QString &lemma)
+{
+    return language + '/' + lemma.toLower();
+}
+
+bool DictionaryCache::isExpired(const Entry &entry) const
+{
+    return m_ttlSeconds > 0 && QDateTime::currentSecsSinceEpoch() - entry.storedAt > m_ttlSeconds;
+}
+
+bool DictionaryCache::lookup(const QString &language, const QString &lemma, QByteArray *answer)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_entries.find(key(language, lemma));
+    if (it == m_entries.end())
+    {
+        ++m_stats.misses;
+        return false;
+    }
+
+    if (isExpired(it.value()))
+    {
+        m_stats.bytes -= it.value().data.size();
+        m_entries.erase(it);
+        ++m_unsaved;
+        ++m_stats.misses;
+        return false;
+    }
+
+    it.value().lastUsed = ++m_clock;
+    ++m_stats.hits;
+
+    if (answer)
+    {
+        *answer = qUncompress(it.value().data);
+    }
+
+    return true;
+}
+
+bool DictionaryCache::contains(const QString &language, const QString &lemma) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_entries.constFind(key(language, lemma));
+    return it != m_entries.constEnd() && !isExpired(it.value());
+}
+
+void DictionaryCache::insert(const QString &language, const QString &lemma, const QByteArray &answer)
+{
+    QMutexLocker locker(&m_mutex);
+
+    Entry entry;
+    entry.data = qCompress(answer);
+    entry.storedAt = QDateTime::currentSecsSinceEpoch();
+    entry.lastUsed = ++m_clock;
+
+    const QString k = key(language, lemma);
+    auto it = m_entries.find(k);
+    if (it != m_entries.end())
+    {
+        m_stats.bytes -= it.value().data.size();
+    }
+
+    m_stats.bytes += entry.data.size();
+    m_entries.insert(k, entry);
+    evict();
+
+    if (++m_unsaved >= SAVE_INTERVAL && !m_pendingSave.isRunning())
+    {
+        saveInBackground();
+    }
+}
+
+void DictionaryCache::saveInBackground()
+{
+    if (m_fileName.isEmpty())
+    {
+        return;
+    }
+
+    //the copy is implicitly shared, so taking it under the lock is cheap;
+    //inserts that arrive during the write just detach from it
+    const QHash<QString, Entry> snapshot = m_entries;
+    const int saved = m_unsaved;
+    m_unsaved = 0;
+
+    m_pendingSave = QtConcurrent::run([this, snapshot, saved]()
+    {
+        const bool written = write(m_fileName, snapshot, m_ttlSeconds);
+        if (!written)
+        {
+            QMutexLocker locker(&m_mutex);
+            m_unsaved += saved;
+        }
+        return written;
+    });
+}
+
+DictionaryCache::Stats DictionaryCache::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    Stats stats = m_stats;
+    stats.entries = m_entries.size();
+    return stats;
+}
+
+void DictionaryCache::evict()
+{
+    if (m_stats.bytes <= m_maxBytes)
+    {
+        return;
+    }
+
+    //drop the oldest entries down to 90% of the budget in one pass,
+    //so inserts at the limit don't rescan the table every time
+    QVector<QPair<quint64, QString>> byAge;
+    byAge.reserve(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it)
+    {
+        byAge.push_back(qMakePair(it.value().lastUsed, it.key()));
+    }
+    std::sort(byAge.begin(), byAge.end());
+
+    const qint64 target = m_maxBytes - m_maxBytes / 10;
+    for (const auto &aged : byAge)
+    {
+        if (m_stats.bytes <= target)
+        {
+            break;
+        }
+
+        m_stats.bytes -= m_entries.value(aged.second).data.size();
+        m_entries.remove(aged.second);
+        ++m_stats.evictions;
+    }
+}
+
+bool DictionaryCache::save()
+{
+    QMutexLocker locker(&m_mutex);
+
+    //never two writers on one file; the worker takes the lock on failure
+    while (m_pendingSave.isRunning())
+    {
+        QFuture<bool> pending = m_pendingSave;
+        locker.unlock();
+        pending.waitForFinished();
+        locker.relock();
+    }
+
+    return saveLocked();
+}
+
+bool DictionaryCache::saveLocked()
+{
+    if (m_unsaved == 0 || m_fileName.isEmpty())
+    {
+        return true;
+    }
+
+    if (!write(m_fileName, m_entries, m_ttlSeconds))
+    {
+        return false;
+    }
+
+    m_unsaved = 0;
+    return true;
+}
+
+bool DictionaryCache::write(const QString &fileName, const QHash<QString, Entry> &entries, qint64 ttlSeconds)
+{
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Cannot write dictionary cache" << fileName << file.errorString();
+        return false;
+    }
+
+    //the header counts what is written, not what is held
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    QVector<QHash<QString, Entry>::const_iterator> live;
+    live.reserve(entries.size());
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it)
+    {
+        if (ttlSeconds <= 0 || now - it.value().storedAt <= ttlSeconds)
+        {
+            live.push_back(it);
+        }
+    }
+
+    QDataStream out(&file);
+    out << CACHE_MAGIC << CACHE_VERSION << qint32(live.size());
+    for (const auto &it : live)
+    {
+        out << it.key() << it.value().storedAt << it.value().lastUsed << it.value().data;
+    }
+
+    return file.commit();
+}
+
+void DictionaryCache::load()
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION)
+    {
+        return;
+    }
+
+    m_entries.reserve(qBound(0, count, 1 << 20));
+    while (!in.atEnd() && in.status() == QDataStream::Ok)
+    {
+        QString k;
+        Entry entry;
+        in >> k >> entry.storedAt >> entry.lastUsed >> entry.data;
+        if (in.status() != QDataStream::Ok)
+        {
+            break;
+        }
+
+        if (isExpired(entry))
+        {
+            continue;
+        }
+
+        m_clock = qMax(m_clock, entry.lastUsed);
+        m_stats.bytes += entry.data.size();
+        m_entries.insert(k, entry);
+    }
+
+    evict();
+}
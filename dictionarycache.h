@@ -0,0 +1,71 @@
+#ifndef DICTIONARYCACHE_H
+#define DICTIONARYCACHE_H
+
+#include <QByteArray>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+//Persistent, size-bounded store of dictionary API responses.
+//Entries are keyed by language code and lemma and kept compressed in
+//memory; the whole table is written back to a single file.
+//Expired entries (TTL) count as misses; the least recently used entries
+//are evicted once the byte budget is exceeded. Batches of new entries are
+//written out on a worker from a snapshot of the table, so inserts never
+//wait for the disk. Thread-safe.
+class DictionaryCache
+{
+public:
+    struct Stats
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        qint64 bytes = 0;
+        int entries = 0;
+    };
+
+    explicit DictionaryCache(const QString &fileName,
+                             qint64 maxBytes = 32 * 1024 * 1024,
+                             qint64 ttlSeconds = 30 * 24 * 3600);
+    ~DictionaryCache();
+
+    static QString defaultFileName();
+
+    bool lookup(const QString &language, const QString &lemma, QByteArray *answer);
+    bool contains(const QString &language, const QString &lemma) const;
+    void insert(const QString &language, const QString &lemma, const QByteArray &answer);
+
+    Stats stats() const;
+    bool save();
+
+private:
+    struct Entry
+    {
+        QByteArray data;    //qCompress'ed response
+        qint64 storedAt;    //secs since epoch
+        quint64 lastUsed;   //LRU clock
+    };
+
+    static QString key(const QString &language, const QString &lemma);
+    static bool write(const QString &fileName, const QHash<QString, Entry> &entries, qint64 ttlSeconds);
+    bool isExpired(const Entry &entry) const;
+    void saveInBackground();
+    bool saveLocked();
+    void load();
+    void evict();
+
+    QString m_fileName;
+    qint64 m_maxBytes;
+    qint64 m_ttlSeconds;
+
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+    quint64 m_clock = 0;
+    int m_unsaved = 0;
+    QFuture<bool> m_pendingSave;
+    Stats m_stats;
+};
+
+#endif // DICTIONARYCACHE_H
@@ -0,0 +1,308 @@
+#include "dictionaryclient.h"
+
+#include "dictionaryapi.h"
+#include "dictionarycache.h"
+
+#include <QNetworkAccessManager>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <cmath>
+
+//latencies kept for the percentiles, oldest overwritten first
+static const int LATENCY_SAMPLES = 1024;
+
+DictionaryClient::DictionaryClient(QNetworkAccessManager *manager, QObject *parent)
+    : QObject(parent)
+    , m_manager(manager)
+{
+    m_clock.start();
+    m_tokens = m_options.burst;
+
+    m_wake.setSingleShot(true);
+    connect(&m_wake, &QTimer::timeout, this, &DictionaryClient::dispatch);
+}
+
+void DictionaryClient::setOptions(const Options &options)
+{
+    m_options = options;
+    m_options.rate = qMax(0.01, m_options.rate);
+    m_options.burst = qMax(1, m_options.burst);
+    m_options.maxInFlight = qMax(1, m_options.maxInFlight);
+    m_tokens = qMin<double>(m_tokens, m_options.burst);
+    dispatch();
+}
+
+void DictionaryClient::setCache(DictionaryCache *cache)
+{
+    m_cache = cache;
+}
+
+QString DictionaryClient::key(const QString &language, const QString &word)
+{
+    return language + '/' + word;
+}
+
+void DictionaryClient::fetch(const QString &language, const QString &word, Priority priority)
+{
+    ++m_stats.fetches;
+
+    const QString k = key(language, word);
+    auto it = m_pending.find(k);
+    if (it != m_pending.end())
+    {
+        ++m_stats.merged;
+
+        //a prefetch somebody is now waiting on jumps the queue
+        if (priority == Interactive && !it->interactive && it->state == Queued)
+        {
+            m_prefetch.removeOne(k);
+            m_interactive.append(k);
+        }
+        (priority == Interactive ? it->interactive : it->prefetch) = true;
+        dispatch();
+        return;
+    }
+
+    Pending pending;
+    pending.language = language;
+    pending.word = word;
+    pending.interactive = priority == Interactive;
+    pending.prefetch = priority == Prefetch;
+    pending.started = m_clock.elapsed();
+    enqueue(k, pending);
+}
+
+void DictionaryClient::cancel(const QString &language, const QString &word)
+{
+    const QString k = key(language, word);
+    auto it = m_pending.find(k);
+    if (it == m_pending.end())
+    {
+        return;
+    }
+
+    it->interactive = false;
+    if (it->prefetch)
+    {
+        if (it->state == Queued && m_interactive.removeOne(k))
+        {
+            m_prefetch.append(k);
+        }
+        return;
+    }
+
+    //already on the wire: let it land in the cache
+    if (it->state == Sending)
+    {
+        return;
+    }
+
+    m_interactive.removeOne(k);
+    ++m_stats.cancelled;
+    complete(k, QNetworkReply::OperationCanceledError, QByteArray());
+}
+
+void DictionaryClient::enqueue(const QString &key, const Pending &pending)
+{
+    Pending &entry = m_pending[key];
+    entry = pending;
+    entry.state = Queued;
+    (entry.interactive ? m_interactive : m_prefetch).append(key);
+    dispatch();
+}
+
+void DictionaryClient::refillTokens()
+{
+    const qint64 now = m_clock.elapsed();
+    m_tokens = qMin<double>(m_options.burst, m_tokens + (now - m_refilledAt) * m_options.rate / 1000.0);
+    m_refilledAt = now;
+}
+
+void DictionaryClient::dispatch()
+{
+    refillTokens();
+
+    while (m_inFlight < m_options.maxInFlight && m_tokens >= 1.0
+           && !(m_interactive.isEmpty() && m_prefetch.isEmpty()))
+    {
+        const QString k = m_interactive.isEmpty() ? m_prefetch.takeFirst() : m_interactive.takeFirst();
+        m_tokens -= 1.0;
+        send(k);
+    }
+
+    //sleep until the bucket holds the next token; a finishing reply
+    //wakes us earlier when the concurrency cap was the limit
+    if (m_inFlight < m_options.maxInFlight && !(m_interactive.isEmpty() && m_prefetch.isEmpty()))
+    {
+        const int delay = int(std::ceil((1.0 - m_tokens) * 1000.0 / m_options.rate));
+        m_wake.start(qMax(1, delay));
+    }
+}
+
+void DictionaryClient::send(const QString &key)
+{
+    Pending &pending = m_pending[key];
+    pending.state = Sending;
+    ++pending.attempts;
+    ++m_stats.requests;
+    ++m_inFlight;
+
+    if (!m_manager)
+    {
+        m_manager = new QNetworkAccessManager(this);
+    }
+
+    QNetworkReply *reply = m_manager->get(DictionaryApi::entriesRequest(pending.language, pending.word));
+    pending.reply = reply;
+
+    connect(reply, &QNetworkReply::finished, this, [this, key, reply]()
+    {
+        replyFinished(key, reply);
+    });
+
+    //the reply is the timer's context, so a finished reply cancels it
+    QTimer::singleShot(m_options.timeout, reply, [reply]()
+    {
+        reply->setProperty("timedOut", true);
+        reply->abort();
+    });
+}
+
+void DictionaryClient::replyFinished(const QString &key, QNetworkReply *reply)
+{
+    reply->deleteLater();
+    --m_inFlight;
+
+    auto it = m_pending.find(key);
+    if (it == m_pending.end() || it->reply != reply)
+    {
+        dispatch();
+        return;
+    }
+    it->reply = nullptr;
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const bool timedOut = reply->property("timedOut").toBool();
+    const QNetworkReply::NetworkError error = reply->error();
+
+    if (error == QNetworkReply::NoError)
+    {
+        const QByteArray answer = reply->readAll();
+        if (m_cache)
+        {
+            m_cache->insert(it->language, it->word, answer);
+        }
+        complete(key, error, answer);
+        dispatch();
+        return;
+    }
+
+    bool retryable = timedOut || status == 429 || status >= 500
+            || error == QNetworkReply::TemporaryNetworkFailureError
+            || error == QNetworkReply::RemoteHostClosedError
+            || error == QNetworkReply::TimeoutError;
+
+    if (timedOut)
+    {
+        ++m_stats.timeouts;
+    }
+
+    int delay = m_options.backoff << qMin(it->attempts - 1, 10);
+    if (status == 429)
+    {
+        ++m_stats.throttled;
+
+        //the server is over its limit for everyone, not just this word
+        m_tokens = 0;
+        m_refilledAt = m_clock.elapsed();
+
+        bool ok = false;
+        const int retryAfter = reply->rawHeader("Retry-After").toInt(&ok);
+        if (ok && retryAfter > 0)
+        {
+            delay = qMax(delay, retryAfter * 1000);
+        }
+    }
+
+    if (!retryable || it->attempts > m_options.maxRetries)
+    {
+        ++m_stats.failures;
+        complete(key, timedOut ? QNetworkReply::TimeoutError : error, QByteArray());
+        dispatch();
+        return;
+    }
+
+    //full jitter in the upper half keeps a burst of failures from
+    //coming back in lockstep
+    ++m_stats.retries;
+    retryLater(key, delay / 2 + int(QRandomGenerator::global()->bounded(delay / 2 + 1)));
+    dispatch();
+}
+
+void DictionaryClient::retryLater(const QString &key, int delay)
+{
+    m_pending[key].state = Waiting;
+
+    QTimer::singleShot(delay, this, [this, key]()
+    {
+        auto it = m_pending.find(key);
+        if (it == m_pending.end() || it->state != Waiting)
+        {
+            return;
+        }
+
+        //the word may have lost every waiter meanwhile
+        if (!it->interactive && !it->prefetch)
+        {
+            ++m_stats.cancelled;
+            complete(key, QNetworkReply::OperationCanceledError, QByteArray());
+            return;
+        }
+
+        it->state = Queued;
+        (it->interactive ? m_interactive : m_prefetch).prepend(key);
+        dispatch();
+    });
+}
+
+void DictionaryClient::complete(const QString &key, QNetworkReply::NetworkError error, const QByteArray &answer)
+{
+    const Pending pending = m_pending.take(key);
+
+    if (error != QNetworkReply::OperationCanceledError)
+    {
+        const qint64 latency = m_clock.elapsed() - pending.started;
+        if (m_latencies.size() < LATENCY_SAMPLES)
+        {
+            m_latencies.append(latency);
+        }
+        else
+        {
+            m_latencies[m_nextLatency] = latency;
+            m_nextLatency = (m_nextLatency + 1) % LATENCY_SAMPLES;
+        }
+    }
+
+    emit finished(pending.language, pending.word, error, answer);
+}
+
+DictionaryClient::Stats DictionaryClient::stats() const
+{
+    Stats stats = m_stats;
+
+    QVector<qint64> sorted = m_latencies;
+    std::sort(sorted.begin(), sorted.end());
+    stats.samples = sorted.size();
+    if (!sorted.isEmpty())
+    {
+        const auto percentile = [&sorted](int p)
+        {
+            return sorted.at(qMin(sorted.size() - 1, sorted.size() * p / 100));
+        };
+        stats.p50 = percentile(50);
+        stats.p90 = percentile(90);
+        stats.p99 = percentile(99);
+        stats.max = sorted.last();
+    }
+    return stats;
+}
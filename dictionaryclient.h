@@ -0,0 +1,136 @@
+#ifndef DICTIONARYCLIENT_H
+#define DICTIONARYCLIENT_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QNetworkReply>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QNetworkAccessManager;
+QT_END_NAMESPACE
+
+class DictionaryCache;
+
+//Shared front end for every online dictionary request.
+//Concurrent fetches of the same language/word ride on one request.
+//Requests leave through a token bucket with a cap on concurrent
+//replies; each attempt has a deadline, and throttling (429), server
+//errors and timeouts are retried with jittered exponential backoff.
+//Interactive lookups always go out ahead of prefetches.
+class DictionaryClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority
+    {
+        Interactive,
+        Prefetch
+    };
+
+    struct Options
+    {
+        double rate = 2.0;      //requests per second, sustained
+        int burst = 4;          //bucket size
+        int maxInFlight = 4;
+        int timeout = 8000;     //ms per attempt
+        int maxRetries = 3;
+        int backoff = 500;      //ms before the first retry, doubled after
+    };
+
+    struct Stats
+    {
+        quint64 fetches = 0;    //fetch() calls
+        quint64 requests = 0;   //HTTP attempts sent
+        quint64 merged = 0;     //fetches that joined one already pending
+        quint64 retries = 0;
+        quint64 timeouts = 0;
+        quint64 throttled = 0;  //429 answers
+        quint64 failures = 0;   //gave up or non-retryable error
+        quint64 cancelled = 0;
+        int samples = 0;        //latencies behind the percentiles
+        qint64 p50 = 0;         //ms from first fetch() to finished()
+        qint64 p90 = 0;
+        qint64 p99 = 0;
+        qint64 max = 0;
+    };
+
+    //without a manager, one is created on the first request: bringing up
+    //the network stack is slow and many sessions never need it
+    explicit DictionaryClient(QNetworkAccessManager *manager = nullptr, QObject *parent = nullptr);
+
+    void setOptions(const Options &options);
+    Options options() const { return m_options; }
+
+    //successful answers are stored here before finished() is emitted
+    void setCache(DictionaryCache *cache);
+
+    //finished() follows exactly once per pending word, however many
+    //callers asked for it
+    void fetch(const QString &language, const QString &word, Priority priority = Interactive);
+
+    //withdraws interactive interest; a word nobody else waits for is
+    //dropped if not yet sent, otherwise it still completes into the cache
+    void cancel(const QString &language, const QString &word);
+
+    Stats stats() const;
+
+signals:
+    void finished(const QString &language, const QString &word,
+                  QNetworkReply::NetworkError error, const QByteArray &answer);
+
+private slots:
+    void dispatch();
+
+private:
+    enum State
+    {
+        Queued,
+        Sending,
+        Waiting
+    };
+
+    struct Pending
+    {
+        QString language;
+        QString word;
+        bool interactive = false;
+        bool prefetch = false;
+        State state = Queued;
+        int attempts = 0;
+        qint64 started = 0;
+        QNetworkReply *reply = nullptr;
+    };
+
+    static QString key(const QString &language, const QString &word);
+    void enqueue(const QString &key, const Pending &pending);
+    void send(const QString &key);
+    void replyFinished(const QString &key, QNetworkReply *reply);
+    void retryLater(const QString &key, int delay);
+    void complete(const QString &key, QNetworkReply::NetworkError error, const QByteArray &answer);
+    void refillTokens();
+
+    QNetworkAccessManager *m_manager = nullptr;
+    DictionaryCache *m_cache = nullptr;
+    Options m_options;
+
+    QHash<QString, Pending> m_pending;
+    QStringList m_interactive;
+    QStringList m_prefetch;
+    int m_inFlight = 0;
+
+    double m_tokens = 0;
+    qint64 m_refilledAt = 0;
+    QElapsedTimer m_clock;
+    QTimer m_wake;
+
+    Stats m_stats;
+    QVector<qint64> m_latencies;
+    int m_nextLatency = 0;
+};
+
+#endif // DICTIONARYCLIENT_H
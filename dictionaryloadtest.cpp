@@ -0,0 +1,143 @@
+#include "dictionaryloadtest.h"
+
+#include "definitionparser.h"
+#include "dictionarycache.h"
+#include "lemmatizer.h"
+#include "subtitlewords.h"
+
+#include <QEventLoop>
+#include <QRandomGenerator>
+#include <algorithm>
+
+DictionaryLoadTest::DictionaryLoadTest(const Options &options, MockDictionaryNetwork *network,
+                                       DictionaryCache *cache, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_network(network)
+    , m_cache(cache)
+    , m_client(new DictionaryClient(network, this))
+{
+    m_options.concurrency = qMax(1, m_options.concurrency);
+    m_network->setOptions(m_options.server);
+    m_client->setOptions(m_options.client);
+    m_client->setCache(m_cache);
+    connect(m_client, &DictionaryClient::finished, this, &DictionaryLoadTest::fetched);
+}
+
+DictionaryLoadTest::Report DictionaryLoadTest::run()
+{
+    m_report = Report();
+    m_latencies.clear();
+    m_issued = 0;
+    m_outstanding = 0;
+
+    if (m_options.words.isEmpty() || m_options.lookups <= 0)
+    {
+        return m_report;
+    }
+
+    m_latencies.reserve(m_options.lookups);
+    m_clock.start();
+
+    QEventLoop loop;
+    m_loop = &loop;
+    issue();
+    if (m_outstanding > 0)
+    {
+        loop.exec();
+    }
+    m_loop = nullptr;
+
+    m_report.elapsed = m_clock.elapsed();
+    m_report.lookups = m_latencies.size();
+    m_report.throughput = m_report.lookups * 1000.0 / qMax<qint64>(1, m_report.elapsed);
+
+    std::sort(m_latencies.begin(), m_latencies.end());
+    const auto percentile = [this](int p)
+    {
+        return m_latencies.at(qMin(m_latencies.size() - 1, m_latencies.size() * p / 100));
+    };
+    m_report.p50 = percentile(50);
+    m_report.p90 = percentile(90);
+    m_report.p99 = percentile(99);
+    m_report.max = m_latencies.last();
+
+    m_report.client = m_client->stats();
+    m_report.server = m_network->stats();
+    return m_report;
+}
+
+void DictionaryLoadTest::issue()
+{
+    QRandomGenerator *random = QRandomGenerator::global();
+
+    //cache hits finish on the spot, so keep going until the window is full
+    while (m_outstanding < m_options.concurrency && m_issued < m_options.lookups)
+    {
+        ++m_issued;
+
+        //squaring a uniform draw favours the first words, like the
+        //handful of words every episode repeats
+        const double u = random->generateDouble();
+        const QString &word = m_options.words.at(int(u * u * m_options.words.size()));
+        const qint64 started = m_clock.elapsed();
+
+        const QString lemma = Lemmatizer::lemma(SubtitleWords::fold(QStringRef(&word)));
+
+        QByteArray cached;
+        if (m_cache->lookup(m_options.language, lemma, &cached))
+        {
+            ++m_report.cacheHits;
+            render(started, cached);
+            continue;
+        }
+
+        ++m_outstanding;
+        m_waiting.insert(lemma, started);
+        m_client->fetch(m_options.language, lemma);
+    }
+
+    if (m_outstanding == 0 && m_loop)
+    {
+        m_loop->quit();
+    }
+}
+
+void DictionaryLoadTest::fetched(const QString &language, const QString &word,
+                                 QNetworkReply::NetworkError error, const QByteArray &answer)
+{
+    if (language != m_options.language)
+    {
+        return;
+    }
+
+    //every lookup of this lemma rode on the same request
+    const QList<qint64> started = m_waiting.values(word);
+    m_waiting.remove(word);
+
+    for (qint64 time : started)
+    {
+        --m_outstanding;
+        if (error != QNetworkReply::NoError)
+        {
+            ++m_report.failures;
+            m_latencies.append(m_clock.elapsed() - time);
+            continue;
+        }
+        render(time, answer);
+    }
+
+    issue();
+}
+
+void DictionaryLoadTest::render(qint64 started, const QByteArray &answer)
+{
+    //same parse and render as the definition panel
+    static thread_local DictionaryEntry entry;
+
+    if (!DefinitionParser::parse(answer, &entry) || DefinitionParser::renderHtml(entry).isEmpty())
+    {
+        ++m_report.failures;
+    }
+    m_latencies.append(m_clock.elapsed() - started);
+}
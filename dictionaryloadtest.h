@@ -0,0 +1,82 @@
+#ifndef DICTIONARYLOADTEST_H
+#define DICTIONARYLOADTEST_H
+
+#include "dictionaryclient.h"
+#include "mockdictionarynetwork.h"
+
+#include <QElapsedTimer>
+#include <QMultiHash>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QEventLoop;
+QT_END_NAMESPACE
+
+class DictionaryCache;
+
+//Drives many word lookups through the same path as a click in the
+//player (lemma, cache, shared client, parse and render) against the
+//in-process mock server, for the --load-test mode.
+//Words are drawn with a skew towards the front of the list, so repeats
+//exercise the cache and request merging like real viewing does.
+class DictionaryLoadTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options
+    {
+        int lookups = 1000;
+        int concurrency = 16;           //lookups outstanding at once
+        QString language = "en-gb";
+        QStringList words;
+        DictionaryClient::Options client;
+        MockDictionaryNetwork::Options server;
+    };
+
+    struct Report
+    {
+        int lookups = 0;
+        int cacheHits = 0;
+        int failures = 0;
+        qint64 elapsed = 0;             //ms, whole run
+        double throughput = 0;          //lookups per second
+        qint64 p50 = 0;                 //ms per lookup, issue to rendered
+        qint64 p90 = 0;
+        qint64 p99 = 0;
+        qint64 max = 0;
+        DictionaryClient::Stats client;
+        MockDictionaryNetwork::Stats server;
+    };
+
+    DictionaryLoadTest(const Options &options, MockDictionaryNetwork *network,
+                       DictionaryCache *cache, QObject *parent = nullptr);
+
+    //blocks in a local event loop until every lookup has finished
+    Report run();
+
+private slots:
+    void fetched(const QString &language, const QString &word,
+                 QNetworkReply::NetworkError error, const QByteArray &answer);
+
+private:
+    void issue();
+    void render(qint64 started, const QByteArray &answer);
+
+    Options m_options;
+    MockDictionaryNetwork *m_network = nullptr;
+    DictionaryCache *m_cache = nullptr;
+    DictionaryClient *m_client = nullptr;
+
+    QEventLoop *m_loop = nullptr;
+    QElapsedTimer m_clock;
+    QMultiHash<QString, qint64> m_waiting;  //lemma -> issue time
+    QVector<qint64> m_latencies;
+    int m_issued = 0;
+    int m_outstanding = 0;
+    Report m_report;
+};
+
+#endif // DICTIONARYLOADTEST_H
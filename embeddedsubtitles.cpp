@@ -0,0 +1,130 @@
+#include "embeddedsubtitles.h"
+
+#include "matroskareader.h"
+#include "mp4reader.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+
+bool EmbeddedSubtitles::canRead(const QString &fileName)
+{
+    static const QStringList suffixes = {"mkv", "mka", "mks", "webm", "mp4", "m4v", "mov"};
+    return suffixes.contains(QFileInfo(fileName).suffix(), Qt::CaseInsensitive);
+}
+
+CueTable EmbeddedSubtitles::read(const QString &fileName, QString *errorString, Stats *stats)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    //unbuffered: reads are small targeted ones, and the Matroska cluster
+    //walk that does need read-ahead buffers its own large chunks
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+    {
+        if (errorString)
+        {
+            *errorString = file.errorString();
+        }
+        return CueTable();
+    }
+
+    char magic[8];
+    if (file.read(magic, sizeof(magic)) != sizeof(magic))
+    {
+        if (errorString)
+        {
+            *errorString = QStringLiteral("File is too short");
+        }
+        return CueTable();
+    }
+
+    QVector<Sample> samples;
+    Stats local;
+    QString error;
+
+    if (quint8(magic[0]) == 0x1A && quint8(magic[1]) == 0x45 && quint8(magic[2]) == 0xDF && quint8(magic[3]) == 0xA3)
+    {
+        MatroskaReader reader(&file);
+        if (!reader.read(&samples))
+        {
+            error = reader.errorString();
+        }
+        local.container = QStringLiteral("Matroska");
+        local.codec = reader.codec();
+        local.language = reader.language();
+        local.bytesRead = reader.bytesRead();
+    }
+    else if (qstrncmp(magic + 4, "ftyp", 4) == 0 || qstrncmp(magic + 4, "moov", 4) == 0)
+    {
+        Mp4Reader reader(&file);
+        if (!reader.read(&samples))
+        {
+            error = reader.errorString();
+        }
+        local.container = QStringLiteral("MP4");
+        local.codec = reader.codec();
+        local.language = reader.language();
+        local.bytesRead = reader.bytesRead();
+    }
+    else
+    {
+        error = QStringLiteral("Not a Matroska or MP4 file");
+    }
+
+    //blocks can be stored slightly out of order
+    std::stable_sort(samples.begin(), samples.end(), [](const Sample &a, const Sample &b)
+    {
+        return a.start < b.start;
+    });
+
+    CueTable cues;
+    int textLength = 0;
+    for (const Sample &sample : samples)
+    {
+        textLength += sample.text.size() + 1;
+    }
+    cues.reserve(samples.size(), textLength);
+
+    for (int i = 0; i < samples.size(); ++i)
+    {
+        const Sample &sample = samples.at(i);
+        if (sample.text.trimmed().isEmpty())
+        {
+            continue;
+        }
+
+        //without a duration a cue lasts until the next one, capped at a few seconds
+        qint64 end = sample.end;
+        if (end <= sample.start)
+        {
+            end = sample.start + 4000;
+            if (i + 1 < samples.size() && samples.at(i + 1).start > sample.start)
+            {
+                end = qMin(end, samples.at(i + 1).start);
+            }
+        }
+
+        cues.append(sample.start, end, sample.text);
+    }
+
+    cues.sort();
+    cues.squeeze();
+
+    if (errorString)
+    {
+        *errorString = error;
+    }
+
+    if (stats)
+    {
+        *stats = local;
+        stats->cues = cues.size();
+        stats->elapsedNs = timer.nsecsElapsed();
+    }
+
+    return cues;
+}
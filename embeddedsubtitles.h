@@ -0,0 +1,36 @@
+#ifndef EMBEDDEDSUBTITLES_H
+#define EMBEDDEDSUBTITLES_H
+
+#include "cuetable.h"
+
+#include <QVector>
+
+//Text subtitle tracks stored inside the video container.
+//Only the container index and the subtitle track's own blocks are read:
+//Matroska files go through SeekHead and Cues, MP4 files through the
+//sample tables in moov. Meant to run off the GUI thread.
+class EmbeddedSubtitles
+{
+public:
+    struct Sample
+    {
+        qint64 start = 0;
+        qint64 end = -1;    //-1 when the container gives no duration
+        QString text;
+    };
+
+    struct Stats
+    {
+        QString container;
+        QString codec;
+        QString language;
+        qint64 bytesRead = 0;
+        int cues = 0;
+        qint64 elapsedNs = 0;
+    };
+
+    static bool canRead(const QString &fileName);
+    static CueTable read(const QString &fileName, QString *errorString = nullptr, Stats *stats = nullptr);
+};
+
+#endif // EMBEDDEDSUBTITLES_H
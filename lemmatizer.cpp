@@ -0,0 +1,357 @@
+#include "lemmatizer.h"
+
+#include <cstring>
+
+namespace Lemmatizer
+{
+
+namespace {
+
+struct Form
+{
+    const char *form;
+    const char *lemma;
+};
+
+//irregular forms, plus exceptions mapped to themselves
+constexpr Form FORMS[] = {
+    {"am", "be"}, {"is", "be"}, {"are", "be"}, {"was", "be"}, {"were", "be"}, {"been", "be"}, {"being", "be"},
+    {"has", "have"}, {"had", "have"}, {"having", "have"},
+    {"does", "do"}, {"did", "do"}, {"done", "do"}, {"doing", "do"},
+    {"goes", "go"}, {"went", "go"}, {"gone", "go"}, {"going", "go"},
+    {"arose", "arise"}, {"arisen", "arise"}, {"awoke", "awake"}, {"bore", "bear"}, {"born", "bear"},
+    {"beaten", "beat"}, {"became", "become"}, {"began", "begin"}, {"begun", "begin"}, {"bent", "bend"},
+    {"bit", "bite"}, {"bitten", "bite"}, {"bled", "bleed"}, {"blew", "blow"}, {"blown", "blow"},
+    {"broke", "break"}, {"broken", "break"}, {"bred", "breed"}, {"brought", "bring"}, {"built", "build"},
+    {"burnt", "burn"}, {"bought", "buy"}, {"caught", "catch"}, {"chose", "choose"}, {"chosen", "choose"},
+    {"came", "come"}, {"crept", "creep"}, {"dealt", "deal"}, {"dug", "dig"}, {"drew", "draw"},
+    {"drawn", "draw"}, {"dreamt", "dream"}, {"drank", "drink"}, {"drunk", "drink"}, {"drove", "drive"},
+    {"driven", "drive"}, {"ate", "eat"}, {"eaten", "eat"}, {"fell", "fall"}, {"fallen", "fall"},
+    {"fed", "feed"}, {"felt", "feel"}, {"fought", "fight"}, {"found", "find"}, {"fled", "flee"},
+    {"flew", "fly"}, {"flown", "fly"}, {"forbade", "forbid"}, {"forgot", "forget"}, {"forgotten", "forget"},
+    {"forgave", "forgive"}, {"forgiven", "forgive"}, {"froze", "freeze"}, {"frozen", "freeze"},
+    {"got", "get"}, {"gotten", "get"}, {"gave", "give"}, {"given", "give"}, {"grew", "grow"},
+    {"grown", "grow"}, {"hung", "hang"}, {"heard", "hear"}, {"hid", "hide"}, {"hidden", "hide"},
+    {"held", "hold"}, {"kept", "keep"}, {"knelt", "kneel"}, {"knew", "know"}, {"known", "know"},
+    {"laid", "lay"}, {"led", "lead"}, {"leapt", "leap"}, {"learnt", "learn"}, {"left", "leave"},
+    {"lent", "lend"}, {"lost", "lose"}, {"made", "make"}, {"meant", "mean"}, {"met", "meet"},
+    {"paid", "pay"}, {"rode", "ride"}, {"ridden", "ride"}, {"rang", "ring"}, {"rung", "ring"},
+    {"rose", "rise"}, {"risen", "rise"}, {"ran", "run"}, {"said", "say"}, {"saw", "see"},
+    {"seen", "see"}, {"sought", "seek"}, {"sold", "sell"}, {"sent", "send"}, {"shook", "shake"},
+    {"shaken", "shake"}, {"shone", "shine"}, {"shot", "shoot"}, {"shown", "show"}, {"shrank", "shrink"},
+    {"sang", "sing"}, {"sung", "sing"}, {"sank", "sink"}, {"sunk", "sink"}, {"sat", "sit"},
+    {"slept", "sleep"}, {"slid", "slide"}, {"spoke", "speak"}, {"spoken", "speak"}, {"spent", "spend"},
+    {"spun", "spin"}, {"spat", "spit"}, {"sprang", "spring"}, {"stood", "stand"}, {"stole", "steal"},
+    {"stolen", "steal"}, {"stuck", "stick"}, {"stung", "sting"}, {"stank", "stink"}, {"struck", "strike"},
+    {"swore", "swear"}, {"sworn", "swear"}, {"swept", "sweep"}, {"swam", "swim"}, {"swum", "swim"},
+    {"swung", "swing"}, {"took", "take"}, {"taken", "take"}, {"taught", "teach"}, {"tore", "tear"},
+    {"torn", "tear"}, {"told", "tell"}, {"thought", "think"}, {"threw", "throw"}, {"thrown", "throw"},
+    {"understood", "understand"}, {"woke", "wake"}, {"woken", "wake"}, {"wore", "wear"}, {"worn", "wear"},
+    {"wept", "weep"}, {"won", "win"}, {"wrote", "write"}, {"written", "write"},
+    {"dying", "die"}, {"died", "die"}, {"dies", "die"}, {"lying", "lie"}, {"lied", "lie"}, {"lies", "lie"},
+    {"tying", "tie"}, {"tied", "tie"}, {"ties", "tie"}, {"pies", "pie"}, {"movies", "movie"},
+    {"cookies", "cookie"}, {"zombies", "zombie"}, {"using", "use"}, {"used", "use"},
+    {"adding", "add"}, {"added", "add"}, {"creating", "create"}, {"created", "create"}, {"changing", "change"}, {"changed", "change"},
+    {"men", "man"}, {"women", "woman"}, {"children", "child"}, {"feet", "foot"}, {"teeth", "tooth"},
+    {"mice", "mouse"}, {"geese", "goose"}, {"lives", "life"}, {"wives", "wife"}, {"knives", "knife"},
+    {"wolves", "wolf"}, {"halves", "half"}, {"thieves", "thief"},
+    {"ourselves", "ourselves"}, {"yourselves", "yourselves"}, {"themselves", "themselves"},
+    {"always", "always"}, {"perhaps", "perhaps"}, {"news", "news"}, {"series", "series"},
+    {"species", "species"}, {"whereas", "whereas"}, {"this", "this"}, {"during", "during"},
+    {"morning", "morning"}, {"evening", "evening"}, {"ceiling", "ceiling"}, {"nothing", "nothing"},
+    {"something", "something"}, {"anything", "anything"}, {"everything", "everything"},
+    {"darling", "darling"}, {"wedding", "wedding"}, {"need", "need"}, {"speed", "speed"},
+    {"seed", "seed"}, {"feed", "feed"}, {"bleed", "bleed"}, {"breed", "breed"}, {"weed", "weed"},
+    {"deed", "deed"}, {"greed", "greed"}, {"indeed", "indeed"}, {"succeed", "succeed"},
+    {"proceed", "proceed"}, {"exceed", "exceed"}, {"hundred", "hundred"}, {"naked", "naked"},
+    {"wicked", "wicked"}, {"sacred", "sacred"}, {"beloved", "beloved"}
+};
+
+constexpr int FORM_COUNT = int(sizeof(FORMS) / sizeof(FORMS[0]));
+
+//Hash-and-displace: a form lands in bucket hash(form, 0) % BUCKETS, and
+//each bucket gets the first seed that sends all its forms to free slots.
+constexpr int BUCKETS = FORM_COUNT / 4 + 1;
+constexpr int SLOTS = 512;
+constexpr int MAX_BUCKET = 16;
+
+static_assert(SLOTS >= FORM_COUNT * 3 / 2, "grow SLOTS with the form table");
+
+constexpr quint32 hash(const char *text, quint32 seed)
+{
+    quint32 h = 2166136261u ^ (seed * 0x9e3779b9u);
+    for (; *text; ++text)
+    {
+        h = (h ^ quint8(*text)) * 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+struct Table
+{
+    quint32 seeds[BUCKETS];
+    qint16 slots[SLOTS];
+};
+
+constexpr Table build()
+{
+    Table table = {};
+    for (int slot = 0; slot < SLOTS; ++slot)
+    {
+        table.slots[slot] = -1;
+    }
+
+    //forms grouped by bucket
+    int bucketOf[FORM_COUNT] = {};
+    int sizes[BUCKETS] = {};
+    for (int form = 0; form < FORM_COUNT; ++form)
+    {
+        bucketOf[form] = int(hash(FORMS[form].form, 0) % BUCKETS);
+        ++sizes[bucketOf[form]];
+    }
+
+    //largest buckets first, while most slots are still free
+    bool placed[BUCKETS] = {};
+    for (int round = 0; round < BUCKETS; ++round)
+    {
+        int bucket = -1;
+        for (int b = 0; b < BUCKETS; ++b)
+        {
+            if (!placed[b] && (bucket < 0 || sizes[b] > sizes[bucket]))
+            {
+                bucket = b;
+            }
+        }
+        placed[bucket] = true;
+
+        int members[MAX_BUCKET] = {};
+        int count = 0;
+        for (int form = 0; form < FORM_COUNT && count < MAX_BUCKET; ++form)
+        {
+            if (bucketOf[form] == bucket)
+            {
+                members[count++] = form;
+            }
+        }
+        if (count == 0)
+        {
+            continue;
+        }
+
+        for (quint32 seed = 1; ; ++seed)
+        {
+            int chosen[MAX_BUCKET] = {};
+            bool free = true;
+            for (int i = 0; i < count && free; ++i)
+            {
+                chosen[i] = int(hash(FORMS[members[i]].form, seed) % SLOTS);
+                free = table.slots[chosen[i]] < 0;
+                for (int j = 0; j < i && free; ++j)
+                {
+                    free = chosen[j] != chosen[i];
+                }
+            }
+
+            if (free)
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    table.slots[chosen[i]] = qint16(members[i]);
+                }
+                table.seeds[bucket] = seed;
+                break;
+            }
+        }
+    }
+
+    return table;
+}
+
+constexpr bool bucketsFit()
+{
+    int sizes[BUCKETS] = {};
+    for (int form = 0; form < FORM_COUNT; ++form)
+    {
+        if (++sizes[hash(FORMS[form].form, 0) % BUCKETS] > MAX_BUCKET)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(bucketsFit(), "a hash bucket outgrew MAX_BUCKET");
+
+constexpr Table TABLE = build();
+
+const char *irregular(const QString &word)
+{
+    //every form is short lower-case ASCII
+    char key[16];
+    if (word.size() >= int(sizeof(key)))
+    {
+        return nullptr;
+    }
+    for (int i = 0; i < word.size(); ++i)
+    {
+        const ushort c = word.at(i).unicode();
+        if (c >= 0x80)
+        {
+            return nullptr;
+        }
+        key[i] = char(c);
+    }
+    key[word.size()] = '\0';
+
+    const quint32 seed = TABLE.seeds[hash(key, 0) % BUCKETS];
+    const int form = TABLE.slots[hash(key, seed) % SLOTS];
+    return form >= 0 && std::strcmp(FORMS[form].form, key) == 0 ? FORMS[form].lemma : nullptr;
+}
+
+bool isVowel(QChar c)
+{
+    return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u';
+}
+
+bool hasVowel(const QString &stem)
+{
+    for (QChar c : stem)
+    {
+        if (isVowel(c) || c == 'y')
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+//stems left after cutting -ing or -ed, best guess first
+QStringList restore(QString stem)
+{
+    const int n = stem.size();
+
+    //stopp -> stop, runn -> run, but fall, kiss and buzz keep theirs
+    if (n >= 3 && stem.at(n - 1) == stem.at(n - 2) && !isVowel(stem.at(n - 1))
+            && stem.at(n - 1) != 'l' && stem.at(n - 1) != 's' && stem.at(n - 1) != 'z')
+    {
+        stem.chop(1);
+        return {stem};
+    }
+
+    //hav -> have, danc -> dance, judg -> judge
+    if (stem.endsWith('v') || stem.endsWith('c') || stem.endsWith(QLatin1String("dg")))
+    {
+        return {stem + 'e'};
+    }
+
+    //the rest only guess at a silent e, so the bare stem stays a candidate:
+    //relat -> relate, clos -> close, amaz -> amaze, realiz -> realize,
+    //decid -> decide, guid -> guide, writ -> write, smil -> smile and
+    //stor -> store; the bare stem covers visit, focus and honor
+    const QChar last = stem.at(n - 1);
+    const bool afterConsonant = n >= 3 && !isVowel(stem.at(n - 3));
+    const bool silentE = (n > 4 && stem.endsWith(QLatin1String("at")) && afterConsonant)
+            || ((last == 's' || last == 'z') && stem.at(n - 2) != last)
+            || (n >= 4 && (stem.endsWith(QLatin1String("it")) || stem.endsWith(QLatin1String("il"))) && afterConsonant)
+            || (n >= 4 && stem.endsWith(QLatin1String("id")) && (afterConsonant || stem.at(n - 3) == 'u'))
+            || (n >= 4 && last == 'r' && stem.at(n - 2) != 'e' && isVowel(stem.at(n - 2)) && afterConsonant);
+
+    //short consonant-vowel-consonant stems lost a silent e: mak, hop, com
+    const bool shortStem = n == 3 && !isVowel(stem.at(0)) && isVowel(stem.at(1)) && !isVowel(last)
+            && last != 'w' && last != 'x' && last != 'y';
+
+    if (silentE || shortStem)
+    {
+        return {stem + 'e', stem};
+    }
+    return {stem};
+}
+
+//what the suffix rules make of a folded word, best guess first; empty
+//when none applies
+QStringList guesses(const QString &w)
+{
+    const int n = w.size();
+
+    if (w.endsWith(QLatin1String("ies")) && n > 4)
+    {
+        return {w.left(n - 3) + 'y'};
+    }
+    if (w.endsWith(QLatin1String("sses")) || w.endsWith(QLatin1String("xes")) || w.endsWith(QLatin1String("ches"))
+            || w.endsWith(QLatin1String("shes")) || w.endsWith(QLatin1String("zzes")))
+    {
+        return {w.left(n - 2)};
+    }
+    //buses, viruses and campuses lost -es, causes and houses only -s
+    if (w.endsWith(QLatin1String("uses")) && n >= 5 && !isVowel(w.at(n - 5)))
+    {
+        return {w.left(n - 2), w.left(n - 1)};
+    }
+    if (w.endsWith(QLatin1String("ses")))
+    {
+        return {w.left(n - 1), w.left(n - 2)};
+    }
+    if (w.endsWith('s') && !w.endsWith(QLatin1String("ss")) && !w.endsWith(QLatin1String("us"))
+            && !w.endsWith(QLatin1String("is")))
+    {
+        return {w.left(n - 1)};
+    }
+
+    if (w.endsWith(QLatin1String("ing")) && n >= 5)
+    {
+        const QString stem = w.left(n - 3);
+        return hasVowel(stem) ? restore(stem) : QStringList();
+    }
+
+    if (w.endsWith(QLatin1String("ied")) && n > 4)
+    {
+        return {w.left(n - 3) + 'y'};
+    }
+    if (w.endsWith(QLatin1String("eed")))
+    {
+        return {w.left(n - 1)};
+    }
+    if (w.endsWith(QLatin1String("ed")))
+    {
+        const QString stem = w.left(n - 2);
+        return hasVowel(stem) ? restore(stem) : QStringList();
+    }
+
+    return QStringList();
+}
+
+} // namespace
+
+QStringList keys(const QString &word)
+{
+    QString w = word.toLower();
+    if (w.endsWith(QLatin1String("'s")))
+    {
+        w.chop(2);
+    }
+
+    if (const char *form = irregular(w))
+    {
+        return {QString::fromLatin1(form)};
+    }
+
+    if (w.size() <= 3)
+    {
+        return {w};
+    }
+
+    //rule output is a guess; the word as written is the last resort
+    QStringList candidates = guesses(w);
+    if (!candidates.contains(w))
+    {
+        candidates.push_back(w);
+    }
+    return candidates;
+}
+
+QString lemma(const QString &word)
+{
+    return keys(word).first();
+}
+
+} // namespace Lemmatizer
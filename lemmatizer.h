@@ -0,0 +1,26 @@
+#ifndef LEMMATIZER_H
+#define LEMMATIZER_H
+
+#include <QStringList>
+
+//Rule-based English lemmatizer for dictionary keys.
+//Irregular forms ("ran", "children", "went") and words the suffix rules
+//would mangle ("morning", "news") come from a table laid out as a perfect
+//hash at compile time; everything else goes through a handful of suffix
+//rules for plurals, -ing and -ed with consonant undoubling and silent-e
+//restoration. Expects a folded word (see SubtitleWords::fold()); words
+//it has no rule for are returned unchanged.
+namespace Lemmatizer
+{
+
+//dictionary keys to try for a word, best first: the lemma, any other
+//guess the suffix rules allow, then the word itself. Irregular forms
+//and words no rule applies to have exactly one key
+QStringList keys(const QString &word);
+
+//the first of keys()
+QString lemma(const QString &word);
+
+} // namespace Lemmatizer
+
+#endif // LEMMATIZER_H
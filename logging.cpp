@@ -0,0 +1,4 @@
+#include "logging.h"
+
+Q_LOGGING_CATEGORY(lcStats, "videodictionary.stats", QtWarningMsg)
+Q_LOGGING_CATEGORY(lcScanner, "videodictionary.scanner", QtWarningMsg)
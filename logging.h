@@ -0,0 +1,16 @@
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <QLoggingCategory>
+
+//Output meant for profiling and diagnosis, not for every run. Both
+//categories are silent unless enabled with QT_LOGGING_RULES, e.g.
+//"videodictionary.*.info=true".
+
+//subtitle parse rates; dictionary request, cache and playback clock
+//totals on exit. --profile-startup turns it on as well
+Q_DECLARE_LOGGING_CATEGORY(lcStats)
+//media files without subtitles and a summary per scan
+Q_DECLARE_LOGGING_CATEGORY(lcScanner)
+
+#endif // LOGGING_H
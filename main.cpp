@@ -49,19 +49,155 @@
 ****************************************************************************/
 
 #include "player.h"
+#include "benchmark.h"
+#include "dictionaryapi.h"
+#include "dictionarycache.h"
+#include "dictionaryloadtest.h"
+#include "mockdictionarynetwork.h"
+#include "offlinedictionary.h"
+#include "startupprofiler.h"
+#include "vocabularyextractor.h"
 
 #include <QApplication>
 #include <QCommandLineParser>
 #include <QCommandLineOption>
+#include <QDebug>
 #include <QDir>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QScopedPointer>
+#include <QTemporaryDir>
 #include <QTextCodec>
 
+//decided before the application object exists, so no display is needed
+static bool isHeadless(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (!qstrcmp(argv[i], "--headless") || !qstrcmp(argv[i], "--load-test")
+                || !qstrcmp(argv[i], "--benchmark"))
+            return true;
+    }
+    return false;
+}
+
+static int runHeadless(const QCommandLineParser &parser, const QString &offlineDictionary)
+{
+    VocabularyExtractor::Options options;
+    options.minCount = qMax(1, parser.value("min-count").toInt());
+    options.jobs = parser.value("jobs").toInt();
+    options.perFile = parser.isSet("per-file");
+
+    QScopedPointer<DictionaryCache> cache;
+    OfflineDictionary dictionary;
+    if (parser.isSet("definitions")) {
+        cache.reset(new DictionaryCache(DictionaryCache::defaultFileName()));
+        options.cache = cache.data();
+        if (!offlineDictionary.isEmpty() && dictionary.openDump(offlineDictionary))
+            options.dictionary = &dictionary;
+    }
+
+    VocabularyExtractor extractor(options);
+    if (!extractor.run(parser.positionalArguments())) {
+        qCritical("No subtitles found in the given files or folders.");
+        return 1;
+    }
+
+    const QString outputFileName = parser.value("output");
+    QString format = parser.value("format").toLower();
+    if (format.isEmpty())
+        format = outputFileName.endsWith(".json", Qt::CaseInsensitive) ? "json" : "csv";
+
+    QFile output;
+    bool opened = false;
+    if (outputFileName.isEmpty() || outputFileName == "-") {
+        opened = output.open(stdout, QIODevice::WriteOnly);
+    } else {
+        output.setFileName(outputFileName);
+        opened = output.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+    if (!opened) {
+        qCritical("Cannot write %s: %s", qPrintable(outputFileName), qPrintable(output.errorString()));
+        return 1;
+    }
+
+    const bool written = format == "json" ? extractor.writeJson(&output) : extractor.writeCsv(&output);
+    return written ? 0 : 1;
+}
+
+static int runLoadTest(const QCommandLineParser &parser, const QString &offlineDictionary)
+{
+    MockDictionaryNetwork network;
+    OfflineDictionary dictionary;
+    if (!offlineDictionary.isEmpty() && dictionary.openDump(offlineDictionary))
+        network.setBackend(&dictionary);
+    if (parser.isSet("mock-recordings"))
+        qInfo() << "Replaying" << network.loadRecordings(parser.value("mock-recordings")) << "recorded answers";
+
+    DictionaryLoadTest::Options options;
+    options.lookups = parser.value("load-test").toInt();
+    options.concurrency = parser.value("concurrency").toInt();
+    options.server.latency = parser.value("mock-latency").toInt();
+    options.server.jitter = options.server.latency / 2;
+    options.server.errorRate = parser.value("mock-errors").toDouble();
+    options.server.rateLimit = parser.value("mock-rate-limit").toInt();
+    options.client.rate = parser.value("request-rate").toDouble();
+    options.client.burst = qMax(1, int(options.client.rate));
+
+    //words come from the given subtitles, else from the recordings
+    if (!parser.positionalArguments().isEmpty()) {
+        VocabularyExtractor extractor((VocabularyExtractor::Options()));
+        extractor.run(parser.positionalArguments());
+        for (const VocabularyExtractor::Word &word : extractor.words())
+            options.words.append(word.word);
+    } else {
+        options.words = network.recordedWords(options.language);
+    }
+    if (options.words.isEmpty()) {
+        qCritical("No words to look up: give subtitle files or folders, or --mock-recordings.");
+        return 1;
+    }
+
+    //a throwaway cache, so every run starts cold
+    QTemporaryDir cacheDirectory;
+    DictionaryCache cache(cacheDirectory.filePath("dictionary.cache"));
+
+    DictionaryLoadTest test(options, &network, &cache);
+    const DictionaryLoadTest::Report report = test.run();
+
+    qInfo() << "Load test:" << report.lookups << "lookups of" << options.words.size() << "words in"
+            << report.elapsed << "ms," << report.throughput << "lookups/s," << report.cacheHits << "cache hits,"
+            << report.failures << "failed";
+    qInfo() << "Lookup latency: p50" << report.p50 << "ms, p90" << report.p90 << "ms, p99" << report.p99
+            << "ms, max" << report.max << "ms";
+    qInfo() << "Client:" << report.client.requests << "requests," << report.client.merged << "merged,"
+            << report.client.retries << "retries," << report.client.timeouts << "timeouts,"
+            << report.client.throttled << "throttled; request p99" << report.client.p99 << "ms";
+    qInfo() << "Server:" << report.server.requests << "requests," << report.server.recorded << "recorded,"
+            << report.server.synthesized << "synthesized," << report.server.notFound << "not found,"
+            << report.server.errors << "errors," << report.server.throttled << "throttled";
+
+    return report.lookups > 0 ? 0 : 1;
+}
+
+static int runBenchmark(const QCommandLineParser &parser)
+{
+    const int failures = Benchmark::run(parser.positionalArguments(), parser.value("iterations").toInt());
+    if (failures > 0)
+        qCritical("%d benchmark check(s) failed.", failures);
+    return failures > 0 ? 1 : 0;
+}
+
 int main(int argc, char *argv[])
 {
+    StartupProfiler::start();
+
     //UTF-8 encoding
     QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
 
-    QApplication app(argc, argv);
+    const bool headless = isHeadless(argc, argv);
+    QScopedPointer<QCoreApplication> app(headless ? new QCoreApplication(argc, argv)
+                                                  : new QApplication(argc, argv));
+    StartupProfiler::mark("application");
 
     QCoreApplication::setApplicationName("Player Example");
     QCoreApplication::setOrganizationName("QtProject");
@@ -70,25 +206,139 @@ int main(int argc, char *argv[])
     QCommandLineOption customAudioRoleOption("custom-audio-role",
                                              "Set a custom audio role for the player.",
                                              "role");
+    QCommandLineOption offlineDictionaryOption("offline-dictionary",
+                                               "Serve lookups from a local tab-separated dictionary dump "
+                                               "before falling back to the Oxford API.",
+                                               "file");
+    QCommandLineOption libraryOption("library",
+                                     "Add every video under this folder to the playlist "
+                                     "(may be given more than once).",
+                                     "folder");
+    QCommandLineOption headlessOption("headless",
+                                      "Build a vocabulary list from the given videos, subtitle files "
+                                      "or folders and exit without opening a window.");
+    QCommandLineOption outputOption("output",
+                                    "Headless: write the list to this file instead of stdout.",
+                                    "file");
+    QCommandLineOption formatOption("format",
+                                    "Headless: csv or json (default: from the output suffix, else csv).",
+                                    "format");
+    QCommandLineOption minCountOption("min-count",
+                                      "Headless: leave out words seen fewer times than this.",
+                                      "count", "1");
+    QCommandLineOption perFileOption("per-file",
+                                     "Headless: also list the words of every file.");
+    QCommandLineOption definitionsOption("definitions",
+                                         "Headless: add definitions from the lookup cache and "
+                                         "the offline dictionary (no network requests).");
+    QCommandLineOption jobsOption("jobs",
+                                  "Headless: number of worker threads (default: one per core).",
+                                  "count", "0");
+    QCommandLineOption dictionaryUrlOption("dictionary-url",
+                                           "Send dictionary requests to this base URL instead of "
+                                           "the Oxford API (e.g. a local stand-in server).",
+                                           "url");
+    QCommandLineOption loadTestOption("load-test",
+                                      "Run this many lookups against an in-process mock dictionary "
+                                      "server, report throughput and latency, and exit. Words come "
+                                      "from the given subtitle files or folders.",
+                                      "lookups");
+    QCommandLineOption concurrencyOption("concurrency",
+                                         "Load test: lookups outstanding at once.",
+                                         "count", "16");
+    QCommandLineOption requestRateOption("request-rate",
+                                         "Load test: client request limit per second.",
+                                         "rate", "2");
+    QCommandLineOption mockRecordingsOption("mock-recordings",
+                                            "Load test: replay <folder>/<language>/<word>.json answers.",
+                                            "folder");
+    QCommandLineOption mockLatencyOption("mock-latency",
+                                         "Load test: mock server latency (plus up to half again as jitter).",
+                                         "ms", "80");
+    QCommandLineOption mockErrorsOption("mock-errors",
+                                        "Load test: fraction of mock requests answered with 503.",
+                                        "fraction", "0");
+    QCommandLineOption profileStartupOption("profile-startup",
+                                            "Log how long each startup phase takes, up to the first "
+                                            "painted window and the first video frame, and how fast "
+                                            "subtitles are parsed.");
+    QCommandLineOption benchmarkOption("benchmark",
+                                       "Check the subtitle parsers and other hot paths against fixed "
+                                       "inputs, time them on large synthetic ones and exit. Suites "
+                                       "may be named as arguments (" + Benchmark::suites().join(", ") + ").");
+    QCommandLineOption iterationsOption("iterations",
+                                        "Benchmark: runs per measurement; the best one is reported.",
+                                        "count", "5");
+    QCommandLineOption mockRateLimitOption("mock-rate-limit",
+                                           "Load test: mock requests per second before 429 (0 = none).",
+                                           "count", "0");
     parser.setApplicationDescription("Qt MultiMedia Player Example");
     parser.addHelpOption();
     parser.addVersionOption();
     parser.addOption(customAudioRoleOption);
-    parser.addPositionalArgument("url", "The URL(s) to open.");
-    parser.process(app);
+    parser.addOption(offlineDictionaryOption);
+    parser.addOption(libraryOption);
+    parser.addOption(headlessOption);
+    parser.addOption(outputOption);
+    parser.addOption(formatOption);
+    parser.addOption(minCountOption);
+    parser.addOption(perFileOption);
+    parser.addOption(definitionsOption);
+    parser.addOption(jobsOption);
+    parser.addOption(dictionaryUrlOption);
+    parser.addOption(loadTestOption);
+    parser.addOption(concurrencyOption);
+    parser.addOption(requestRateOption);
+    parser.addOption(mockRecordingsOption);
+    parser.addOption(mockLatencyOption);
+    parser.addOption(mockErrorsOption);
+    parser.addOption(mockRateLimitOption);
+    parser.addOption(profileStartupOption);
+    parser.addOption(benchmarkOption);
+    parser.addOption(iterationsOption);
+    parser.addPositionalArgument("url", "The URL(s) to open, or in headless mode the files and folders to read.");
+    parser.process(*app);
+    StartupProfiler::setEnabled(parser.isSet(profileStartupOption));
+    if (parser.isSet(profileStartupOption))
+        QLoggingCategory::setFilterRules(QStringLiteral("videodictionary.stats.info=true"));
+    StartupProfiler::mark("command line");
+
+    if (parser.isSet(dictionaryUrlOption))
+        DictionaryApi::setBaseUrl(QUrl::fromUserInput(parser.value(dictionaryUrlOption)));
+
+    if (parser.isSet(benchmarkOption))
+        return runBenchmark(parser);
+
+    if (parser.isSet(loadTestOption))
+        return runLoadTest(parser, parser.value(offlineDictionaryOption));
+
+    if (headless)
+        return runHeadless(parser, parser.value(offlineDictionaryOption));
 
     Player player;
+    StartupProfiler::mark("player window");
 
     if (parser.isSet(customAudioRoleOption))
         player.setCustomAudioRole(parser.value(customAudioRoleOption));
 
+    if (parser.isSet(offlineDictionaryOption))
+        player.setOfflineDictionary(parser.value(offlineDictionaryOption));
+
     if (!parser.positionalArguments().isEmpty() && player.isPlayerAvailable()) {
-        QList<QUrl> urls;
+        QStringList files;
         for (auto &a: parser.positionalArguments())
-            urls.append(QUrl::fromUserInput(a, QDir::currentPath(), QUrl::AssumeLocalFile));
+            files.append(QUrl::fromUserInput(a, QDir::currentPath(), QUrl::AssumeLocalFile).toLocalFile());
+        player.openMedia(files);
     }
 
+    if (parser.isSet(libraryOption) && player.isPlayerAvailable())
+        player.scanLibrary(parser.values(libraryOption));
+
+    StartupProfiler::mark("open media");
+
+    StartupProfiler::watchFirstPaint(&player);
     player.setWindowState(Qt::WindowMaximized);
     player.show();
-    return app.exec();
+    StartupProfiler::mark("show");
+    return app->exec();
 }
@@ -0,0 +1,905 @@
+#include "matroskareader.h"
+
+#include "assparser.h"
+
+#include <QIODevice>
+#include <QSet>
+#include <QtEndian>
+
+#include <cstring>
+
+namespace {
+
+enum : quint32
+{
+    EbmlHeader = 0x1A45DFA3,
+    Segment = 0x18538067,
+    SeekHead = 0x114D9B74,
+    Seek = 0x4DBB,
+    SeekID = 0x53AB,
+    SeekPosition = 0x53AC,
+    Info = 0x1549A966,
+    TimecodeScale = 0x2AD7B1,
+    Tracks = 0x1654AE6B,
+    TrackEntry = 0xAE,
+    TrackNumber = 0xD7,
+    TrackType = 0x83,
+    CodecID = 0x86,
+    Language = 0x22B59C,
+    LanguageIETF = 0x22B59D,
+    FlagForced = 0x55AA,
+    ContentEncodings = 0x6D80,
+    ContentEncoding = 0x6240,
+    ContentEncodingType = 0x5033,
+    ContentCompression = 0x5034,
+    ContentCompAlgo = 0x4254,
+    ContentCompSettings = 0x4255,
+    ContentEncryption = 0x5035,
+    Cues = 0x1C53BB6B,
+    CuePoint = 0xBB,
+    CueTrackPositions = 0xB7,
+    CueTrack = 0xF7,
+    CueClusterPosition = 0xF1,
+    CueRelativePosition = 0xF0,
+    CueDuration = 0xB2,
+    Cluster = 0x1F43B675,
+    Timecode = 0xE7,
+    SimpleBlock = 0xA3,
+    BlockGroup = 0xA0,
+    Block = 0xA1,
+    BlockDuration = 0x9B,
+    Chapters = 0x1043A770,
+    Tags = 0x1254C367,
+    Attachments = 0x1941A469
+};
+
+const quint64 SubtitleTrackType = 0x11;
+const qint64 MaxMetadataSize = 64 * 1024 * 1024;
+const qint64 MaxFrameSize = 1024 * 1024;
+const qint64 ReadAheadSize = 1024 * 1024;
+
+//level-1 elements, which also end an unknown-sized cluster
+bool isTopLevel(quint32 id)
+{
+    return id == Cluster || id == Cues || id == SeekHead || id == Info || id == Tracks
+            || id == Chapters || id == Tags || id == Attachments;
+}
+
+int vintLength(quint8 first)
+{
+    for (int length = 1; length <= 8; ++length)
+    {
+        if (first & (0x80 >> (length - 1)))
+        {
+            return length;
+        }
+    }
+    return 0;
+}
+
+//EBML element id and data size; size is -1 for "unknown"
+bool parseHeader(const uchar *data, qint64 available, quint32 *id, int *headerLength, qint64 *size)
+{
+    if (available < 2)
+    {
+        return false;
+    }
+
+    const int idLength = vintLength(data[0]);
+    if (idLength == 0 || idLength > 4 || idLength >= available)
+    {
+        return false;
+    }
+
+    const int sizeLength = vintLength(data[idLength]);
+    if (sizeLength == 0 || idLength + sizeLength > available)
+    {
+        return false;
+    }
+
+    quint32 elementId = 0;
+    for (int i = 0; i < idLength; ++i)
+    {
+        elementId = (elementId << 8) | data[i];
+    }
+
+    const quint8 mask = quint8(0xFF >> sizeLength);
+    quint64 value = data[idLength] & mask;
+    bool unknown = (data[idLength] & mask) == mask;
+    for (int i = 1; i < sizeLength; ++i)
+    {
+        value = (value << 8) | data[idLength + i];
+        unknown = unknown && data[idLength + i] == 0xFF;
+    }
+
+    *id = elementId;
+    *headerLength = idLength + sizeLength;
+    *size = unknown ? -1 : qint64(qMin<quint64>(value, quint64(1) << 56));
+    return true;
+}
+
+//children of a master element already held in memory
+class Children
+{
+public:
+    Children(const QByteArray &data, int begin, int end)
+        : m_data(data)
+        , m_next(begin)
+        , m_end(end)
+    {
+    }
+
+    bool next()
+    {
+        int headerLength = 0;
+        qint64 size = 0;
+        if (m_next >= m_end
+                || !parseHeader(reinterpret_cast<const uchar *>(m_data.constData()) + m_next, m_end - m_next,
+                                &m_id, &headerLength, &size)
+                || size < 0)
+        {
+            return false;
+        }
+
+        m_begin = m_next + headerLength;
+        m_size = int(qMin<qint64>(size, m_end - m_begin));
+        m_next = m_begin + m_size;
+        return true;
+    }
+
+    quint32 id() const { return m_id; }
+    int begin() const { return m_begin; }
+    int end() const { return m_begin + m_size; }
+
+    quint64 toUInt() const
+    {
+        quint64 value = 0;
+        for (int i = 0; i < qMin(m_size, 8); ++i)
+        {
+            value = (value << 8) | quint8(m_data.at(m_begin + i));
+        }
+        return value;
+    }
+
+    QByteArray toBytes() const
+    {
+        return m_data.mid(m_begin, m_size);
+    }
+
+    QByteArray toString() const
+    {
+        QByteArray value = toBytes();
+        while (value.endsWith('\0'))
+        {
+            value.chop(1);
+        }
+        return value;
+    }
+
+private:
+    const QByteArray &m_data;
+    quint32 m_id = 0;
+    int m_next;
+    int m_end;
+    int m_begin = 0;
+    int m_size = 0;
+};
+
+} // namespace
+
+MatroskaReader::MatroskaReader(QIODevice *device)
+    : m_device(device)
+{
+}
+
+bool MatroskaReader::read(QVector<EmbeddedSubtitles::Sample> *samples)
+{
+    m_samples = samples;
+    const qint64 fileSize = m_device->size();
+
+    Element element;
+    if (!readElement(0, fileSize, &element) || element.id != EbmlHeader || element.size < 0)
+    {
+        setError(QStringLiteral("Not a Matroska file"));
+        return false;
+    }
+
+    if (!readElement(element.end(), fileSize, &element) || element.id != Segment)
+    {
+        setError(QStringLiteral("Matroska segment not found"));
+        return false;
+    }
+
+    m_segmentPos = element.dataPos;
+    m_segmentEnd = element.size < 0 ? fileSize : element.end();
+
+    //level-1 elements up to the first cluster; anything after it is reached through the SeekHead
+    bool haveInfo = false;
+    bool haveTracks = false;
+    qint64 cuesPos = -1;
+    qint64 firstCluster = -1;
+
+    qint64 pos = m_segmentPos;
+    while (pos < m_segmentEnd && readElement(pos, m_segmentEnd, &element))
+    {
+        if (element.id == Cluster)
+        {
+            firstCluster = pos;
+            break;
+        }
+
+        if (element.size < 0)
+        {
+            break;
+        }
+
+        switch (element.id)
+        {
+        case SeekHead:
+            parseSeekHead(element);
+            break;
+        case Info:
+            parseInfo(element);
+            haveInfo = true;
+            break;
+        case Tracks:
+            parseTracks(element);
+            haveTracks = true;
+            break;
+        case Cues:
+            cuesPos = pos;
+            break;
+        }
+
+        pos = element.end();
+    }
+
+    //muxers often leave a short SeekHead up front that points at a full one at the end
+    if (m_seek.contains(SeekHead))
+    {
+        if (readElement(m_seek.take(SeekHead), m_segmentEnd, &element) && element.id == SeekHead && element.size >= 0)
+        {
+            parseSeekHead(element);
+        }
+    }
+
+    if (!haveInfo && m_seek.contains(Info)
+            && readElement(m_seek.value(Info), m_segmentEnd, &element) && element.id == Info && element.size >= 0)
+    {
+        parseInfo(element);
+    }
+
+    if (!haveTracks && m_seek.contains(Tracks)
+            && readElement(m_seek.value(Tracks), m_segmentEnd, &element) && element.id == Tracks && element.size >= 0)
+    {
+        parseTracks(element);
+    }
+
+    if (cuesPos < 0)
+    {
+        cuesPos = m_seek.value(Cues, -1);
+    }
+
+    if (firstCluster < 0)
+    {
+        firstCluster = m_seek.value(Cluster, -1);
+    }
+
+    //prefer an English track that is not just the forced (foreign dialogue only) one
+    int best = -1;
+    int bestScore = -1;
+    QString unsupported;
+    for (int i = 0; i < m_tracks.size(); ++i)
+    {
+        const Track &track = m_tracks.at(i);
+        if (!track.codec.startsWith("S_TEXT/") || track.encrypted)
+        {
+            continue;
+        }
+
+        //ContentCompAlgo 1 is bzlib, 2 is LZO; neither ships with Qt
+        if (track.compression == 1 || track.compression == 2)
+        {
+            unsupported = QStringLiteral("Subtitle track uses unsupported %1 compression")
+                    .arg(track.compression == 1 ? QStringLiteral("bzlib") : QStringLiteral("LZO"));
+            continue;
+        }
+
+        const int score = (track.language.startsWith("en") ? 2 : 0) + (track.forced ? 0 : 1);
+        if (score > bestScore)
+        {
+            best = i;
+            bestScore = score;
+        }
+    }
+
+    if (best < 0)
+    {
+        setError(unsupported.isEmpty() ? QStringLiteral("No text subtitle track") : unsupported);
+        return false;
+    }
+    m_track = m_tracks.at(best);
+
+    QVector<CueRef> refs;
+    if (cuesPos >= 0 && readElement(cuesPos, m_segmentEnd, &element) && element.id == Cues && element.size >= 0)
+    {
+        parseCues(element, &refs);
+    }
+
+    if (!refs.isEmpty())
+    {
+        //the index points at each subtitle block, so only those are read
+        QSet<qint64> visited;
+        for (const CueRef &ref : refs)
+        {
+            ClusterInfo cluster;
+            if (!clusterAt(m_segmentPos + ref.cluster, &cluster))
+            {
+                continue;
+            }
+
+            if (ref.relative < 0)
+            {
+                if (!visited.contains(cluster.pos))
+                {
+                    visited.insert(cluster.pos);
+                    m_readAhead = true;
+                    if (readElement(cluster.pos, m_segmentEnd, &element))
+                    {
+                        scanCluster(element);
+                    }
+                    m_readAhead = false;
+                }
+                continue;
+            }
+
+            const qint64 blockPos = cluster.dataPos + ref.relative;
+            if (visited.contains(blockPos) || !readElement(blockPos, m_segmentEnd, &element) || element.size < 0)
+            {
+                continue;
+            }
+            visited.insert(blockPos);
+
+            if (element.id == SimpleBlock || element.id == Block)
+            {
+                readBlock(element, cluster.timecode, ref.duration);
+            }
+            else if (element.id == BlockGroup)
+            {
+                readBlockGroup(element, cluster.timecode, ref.duration);
+            }
+        }
+    }
+    else if (firstCluster >= 0)
+    {
+        //no index for the subtitle track: walk block headers, skipping other
+        //tracks' payloads; headers are close together, so read in large chunks
+        m_readAhead = true;
+        pos = firstCluster;
+        while (pos < m_segmentEnd && readElement(pos, m_segmentEnd, &element))
+        {
+            if (element.id == Cluster)
+            {
+                pos = scanCluster(element);
+            }
+            else if (element.size < 0)
+            {
+                break;
+            }
+            else
+            {
+                pos = element.end();
+            }
+        }
+        m_readAhead = false;
+    }
+
+    return true;
+}
+
+qint64 MatroskaReader::readAt(qint64 pos, char *data, qint64 size)
+{
+    if (m_readAhead && size <= ReadAheadSize)
+    {
+        //refill only when the read is not already buffered; a large
+        //payload being skipped costs one refill at the next header
+        if (pos < m_bufferPos || pos + size > m_bufferPos + m_buffer.size())
+        {
+            m_buffer.resize(int(ReadAheadSize));
+            const qint64 got = m_device->seek(pos) ? m_device->read(m_buffer.data(), ReadAheadSize) : -1;
+            if (got <= 0)
+            {
+                m_buffer.clear();
+                return -1;
+            }
+            m_buffer.resize(int(got));
+            m_bufferPos = pos;
+            m_bytesRead += got;
+        }
+
+        const qint64 got = qMin(size, m_bufferPos + m_buffer.size() - pos);
+        std::memcpy(data, m_buffer.constData() + (pos - m_bufferPos), size_t(got));
+        return got;
+    }
+
+    if (!m_device->seek(pos))
+    {
+        return -1;
+    }
+
+    const qint64 got = m_device->read(data, size);
+    if (got > 0)
+    {
+        m_bytesRead += got;
+    }
+    return got;
+}
+
+bool MatroskaReader::readElement(qint64 pos, qint64 limit, Element *element)
+{
+    uchar header[12];
+    const qint64 wanted = qMin<qint64>(sizeof(header), limit - pos);
+    if (wanted < 2)
+    {
+        return false;
+    }
+
+    const qint64 got = readAt(pos, reinterpret_cast<char *>(header), wanted);
+    if (got <= 0)
+    {
+        return false;
+    }
+
+    int headerLength = 0;
+    qint64 size = 0;
+    if (!parseHeader(header, got, &element->id, &headerLength, &size))
+    {
+        return false;
+    }
+
+    element->pos = pos;
+    element->dataPos = pos + headerLength;
+    element->size = size < 0 ? -1 : qMin(size, limit - element->dataPos);
+    return true;
+}
+
+bool MatroskaReader::readData(qint64 pos, qint64 size, QByteArray *data)
+{
+    if (size < 0)
+    {
+        return false;
+    }
+
+    data->resize(int(size));
+    return readAt(pos, data->data(), size) == size;
+}
+
+quint64 MatroskaReader::readUInt(const Element &element)
+{
+    QByteArray data;
+    if (element.size > 8 || !readData(element.dataPos, element.size, &data))
+    {
+        return 0;
+    }
+
+    quint64 value = 0;
+    for (char c : data)
+    {
+        value = (value << 8) | quint8(c);
+    }
+    return value;
+}
+
+bool MatroskaReader::readMaster(const Element &element, QByteArray *data)
+{
+    return element.size >= 0 && element.size <= MaxMetadataSize && readData(element.dataPos, element.size, data);
+}
+
+void MatroskaReader::parseSeekHead(const Element &seekHead)
+{
+    QByteArray data;
+    if (!readMaster(seekHead, &data))
+    {
+        return;
+    }
+
+    Children seeks(data, 0, data.size());
+    while (seeks.next())
+    {
+        if (seeks.id() != Seek)
+        {
+            continue;
+        }
+
+        quint32 id = 0;
+        qint64 position = -1;
+        Children fields(data, seeks.begin(), seeks.end());
+        while (fields.next())
+        {
+            if (fields.id() == SeekID)
+            {
+                id = quint32(fields.toUInt());
+            }
+            else if (fields.id() == SeekPosition)
+            {
+                position = qint64(fields.toUInt());
+            }
+        }
+
+        //the first entry wins, e.g. the first of several clusters
+        if (id != 0 && position >= 0 && !m_seek.contains(id) && m_segmentPos + position != seekHead.pos)
+        {
+            m_seek.insert(id, m_segmentPos + position);
+        }
+    }
+}
+
+void MatroskaReader::parseInfo(const Element &info)
+{
+    QByteArray data;
+    if (!readMaster(info, &data))
+    {
+        return;
+    }
+
+    Children fields(data, 0, data.size());
+    while (fields.next())
+    {
+        if (fields.id() == TimecodeScale && fields.toUInt() > 0)
+        {
+            m_timecodeScale = fields.toUInt();
+        }
+    }
+}
+
+void MatroskaReader::parseTracks(const Element &tracks)
+{
+    QByteArray data;
+    if (!readMaster(tracks, &data))
+    {
+        return;
+    }
+
+    Children entries(data, 0, data.size());
+    while (entries.next())
+    {
+        if (entries.id() != TrackEntry)
+        {
+            continue;
+        }
+
+        Track track;
+        quint64 type = 0;
+        Children fields(data, entries.begin(), entries.end());
+        while (fields.next())
+        {
+            switch (fields.id())
+            {
+            case TrackNumber:
+                track.number = fields.toUInt();
+                break;
+            case TrackType:
+                type = fields.toUInt();
+                break;
+            case CodecID:
+                track.codec = fields.toString();
+                break;
+            case Language:
+            case LanguageIETF:
+                track.language = fields.toString();
+                break;
+            case FlagForced:
+                track.forced = fields.toUInt() != 0;
+                break;
+            case ContentEncodings:
+                parseContentEncodings(data, fields.begin(), fields.end(), &track);
+                break;
+            }
+        }
+
+        if (type == SubtitleTrackType && track.number != 0)
+        {
+            m_tracks.push_back(track);
+        }
+    }
+}
+
+void MatroskaReader::parseContentEncodings(const QByteArray &data, int begin, int end, Track *track)
+{
+    Children encodings(data, begin, end);
+    while (encodings.next())
+    {
+        if (encodings.id() != ContentEncoding)
+        {
+            continue;
+        }
+
+        Children fields(data, encodings.begin(), encodings.end());
+        while (fields.next())
+        {
+            if (fields.id() == ContentEncryption || (fields.id() == ContentEncodingType && fields.toUInt() != 0))
+            {
+                track->encrypted = true;
+            }
+            else if (fields.id() == ContentCompression)
+            {
+                //ContentCompAlgo defaults to zlib
+                track->compression = 0;
+                Children settings(data, fields.begin(), fields.end());
+                while (settings.next())
+                {
+                    if (settings.id() == ContentCompAlgo)
+                    {
+                        track->compression = int(settings.toUInt());
+                    }
+                    else if (settings.id() == ContentCompSettings)
+                    {
+                        track->compressionSettings = settings.toBytes();
+                    }
+                }
+            }
+        }
+    }
+}
+
+void MatroskaReader::parseCues(const Element &cues, QVector<CueRef> *refs)
+{
+    QByteArray data;
+    if (!readMaster(cues, &data))
+    {
+        return;
+    }
+
+    Children points(data, 0, data.size());
+    while (points.next())
+    {
+        if (points.id() != CuePoint)
+        {
+            continue;
+        }
+
+        Children positions(data, points.begin(), points.end());
+        while (positions.next())
+        {
+            if (positions.id() != CueTrackPositions)
+            {
+                continue;
+            }
+
+            quint64 track = 0;
+            CueRef ref = {-1, -1, -1};
+            Children fields(data, positions.begin(), positions.end());
+            while (fields.next())
+            {
+                switch (fields.id())
+                {
+                case CueTrack:
+                    track = fields.toUInt();
+                    break;
+                case CueClusterPosition:
+                    ref.cluster = qint64(fields.toUInt());
+                    break;
+                case CueRelativePosition:
+                    ref.relative = qint64(fields.toUInt());
+                    break;
+                case CueDuration:
+                    ref.duration = qint64(fields.toUInt());
+                    break;
+                }
+            }
+
+            if (track == m_track.number && ref.cluster >= 0)
+            {
+                refs->push_back(ref);
+            }
+        }
+    }
+}
+
+bool MatroskaReader::clusterAt(qint64 pos, ClusterInfo *cluster)
+{
+    const auto cached = m_clusters.constFind(pos);
+    if (cached != m_clusters.constEnd())
+    {
+        *cluster = cached.value();
+        return true;
+    }
+
+    Element element;
+    if (!readElement(pos, m_segmentEnd, &element) || element.id != Cluster)
+    {
+        return false;
+    }
+
+    cluster->pos = pos;
+    cluster->dataPos = element.dataPos;
+    cluster->timecode = 0;
+
+    //Timecode is the first child in practice, but only CRC-32/Void may legally precede it
+    const qint64 end = element.size < 0 ? m_segmentEnd : element.end();
+    Element child;
+    for (qint64 childPos = element.dataPos; childPos < end && readElement(childPos, end, &child) && child.size >= 0; childPos = child.end())
+    {
+        if (child.id == Timecode)
+        {
+            cluster->timecode = qint64(readUInt(child));
+            break;
+        }
+
+        if (child.id == SimpleBlock || child.id == BlockGroup)
+        {
+            break;
+        }
+    }
+
+    m_clusters.insert(pos, *cluster);
+    return true;
+}
+
+qint64 MatroskaReader::scanCluster(const Element &cluster)
+{
+    const qint64 end = cluster.size < 0 ? m_segmentEnd : cluster.end();
+    qint64 timecode = 0;
+
+    Element child;
+    qint64 pos = cluster.dataPos;
+    while (pos < end && readElement(pos, end, &child))
+    {
+        //an unknown-sized cluster ends where the next level-1 element starts
+        if (cluster.size < 0 && isTopLevel(child.id))
+        {
+            return pos;
+        }
+
+        if (child.size < 0)
+        {
+            break;
+        }
+
+        switch (child.id)
+        {
+        case Timecode:
+            timecode = qint64(readUInt(child));
+            break;
+        case SimpleBlock:
+            readBlock(child, timecode, -1);
+            break;
+        case BlockGroup:
+            readBlockGroup(child, timecode, -1);
+            break;
+        }
+
+        pos = child.end();
+    }
+
+    return end;
+}
+
+bool MatroskaReader::blockHeader(const Element &block, int *headerLength, qint16 *relative)
+{
+    uchar header[11];
+    const qint64 wanted = qMin<qint64>(sizeof(header), block.size);
+    if (wanted < 4 || readAt(block.dataPos, reinterpret_cast<char *>(header), wanted) != wanted)
+    {
+        return false;
+    }
+
+    const int length = vintLength(header[0]);
+    if (length == 0 || length + 3 > wanted)
+    {
+        return false;
+    }
+
+    quint64 track = header[0] & (0xFF >> length);
+    for (int i = 1; i < length; ++i)
+    {
+        track = (track << 8) | header[i];
+    }
+
+    //laced frames are never used for text subtitles
+    const quint8 flags = header[length + 2];
+    if (track != m_track.number || (flags & 0x06) != 0)
+    {
+        return false;
+    }
+
+    *headerLength = length + 3;
+    *relative = qint16((header[length] << 8) | header[length + 1]);
+    return true;
+}
+
+void MatroskaReader::readBlock(const Element &block, qint64 clusterTime, qint64 duration)
+{
+    int headerLength = 0;
+    qint16 relative = 0;
+    QByteArray frame;
+    if (!blockHeader(block, &headerLength, &relative) || block.size - headerLength > MaxFrameSize
+            || !readData(block.dataPos + headerLength, block.size - headerLength, &frame))
+    {
+        return;
+    }
+
+    const qint64 time = clusterTime + relative;
+
+    EmbeddedSubtitles::Sample sample;
+    sample.start = time * qint64(m_timecodeScale) / 1000000;
+    sample.end = duration > 0 ? (time + duration) * qint64(m_timecodeScale) / 1000000 : -1;
+    sample.text = frameText(frame);
+    m_samples->push_back(sample);
+}
+
+void MatroskaReader::readBlockGroup(const Element &group, qint64 clusterTime, qint64 duration)
+{
+    Element block;
+    Element child;
+    int headerLength = 0;
+    qint16 relative = 0;
+
+    for (qint64 pos = group.dataPos; pos < group.end() && readElement(pos, group.end(), &child) && child.size >= 0; pos = child.end())
+    {
+        if (child.id == Block)
+        {
+            //most groups belong to video; bail out before touching their payload
+            if (!blockHeader(child, &headerLength, &relative))
+            {
+                return;
+            }
+            block = child;
+        }
+        else if (child.id == BlockDuration)
+        {
+            duration = qint64(readUInt(child));
+        }
+    }
+
+    if (block.id == Block)
+    {
+        readBlock(block, clusterTime, duration);
+    }
+}
+
+QString MatroskaReader::frameText(QByteArray frame) const
+{
+    if (m_track.compression == 3)
+    {
+        //header stripping
+        frame.prepend(m_track.compressionSettings);
+    }
+    else if (m_track.compression == 0)
+    {
+        //qUncompress wants a size hint up front; it grows the buffer if the hint is short
+        QByteArray packed(4, '\0');
+        qToBigEndian(quint32(frame.size() * 4), reinterpret_cast<uchar *>(packed.data()));
+        frame = qUncompress(packed + frame);
+    }
+
+    while (frame.endsWith('\0'))
+    {
+        frame.chop(1);
+    }
+
+    const QString text = QString::fromUtf8(frame);
+    if (m_track.codec != "S_TEXT/ASS" && m_track.codec != "S_TEXT/SSA")
+    {
+        return text;
+    }
+
+    //ReadOrder, Layer, Style, Name, MarginL, MarginR, MarginV, Effect, Text
+    int pos = 0;
+    for (int commas = 0; pos < text.size() && commas < 8; ++pos)
+    {
+        if (text.at(pos) == QLatin1Char(','))
+        {
+            ++commas;
+        }
+    }
+
+    QString plain;
+    AssParser::appendPlainText(text.constData() + pos, text.size() - pos, &plain);
+    return plain;
+}
+
+void MatroskaReader::setError(const QString &error)
+{
+    m_errorString = error;
+}
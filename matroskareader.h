@@ -0,0 +1,109 @@
+#ifndef MATROSKAREADER_H
+#define MATROSKAREADER_H
+
+#include "embeddedsubtitles.h"
+
+#include <QByteArray>
+#include <QHash>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+//Pulls the text subtitle track out of a Matroska/WebM file.
+//Segment metadata is located through the SeekHead, subtitle blocks through
+//the Cues index (CueClusterPosition + CueRelativePosition), so only a few
+//bytes per cue are read. Files whose Cues do not cover the subtitle track
+//fall back to walking cluster and block headers, reading payloads of the
+//subtitle track only; that walk reads the file in large chunks instead
+//of one small read per header.
+//zlib and header-stripping compression are handled; bzlib and LZO are not.
+class MatroskaReader
+{
+public:
+    explicit MatroskaReader(QIODevice *device);
+
+    bool read(QVector<EmbeddedSubtitles::Sample> *samples);
+
+    QString errorString() const { return m_errorString; }
+    QString codec() const { return QString::fromLatin1(m_track.codec); }
+    QString language() const { return QString::fromLatin1(m_track.language); }
+    qint64 bytesRead() const { return m_bytesRead; }
+
+private:
+    struct Element
+    {
+        quint32 id = 0;
+        qint64 pos = 0;
+        qint64 dataPos = 0;
+        qint64 size = -1;   //-1 for unknown-sized elements
+
+        qint64 end() const { return dataPos + size; }
+    };
+
+    struct Track
+    {
+        quint64 number = 0;
+        QByteArray codec;
+        QByteArray language = "eng";
+        bool forced = false;
+        bool encrypted = false;
+        int compression = -1;   //ContentCompAlgo, -1 when not compressed
+        QByteArray compressionSettings;
+    };
+
+    struct CueRef
+    {
+        qint64 cluster;     //relative to the segment data
+        qint64 relative;    //-1 when the muxer did not write it
+        qint64 duration;
+    };
+
+    struct ClusterInfo
+    {
+        qint64 pos = 0;
+        qint64 dataPos = 0;
+        qint64 timecode = 0;
+    };
+
+    qint64 readAt(qint64 pos, char *data, qint64 size);
+    bool readElement(qint64 pos, qint64 limit, Element *element);
+    bool readData(qint64 pos, qint64 size, QByteArray *data);
+    bool readMaster(const Element &element, QByteArray *data);
+    quint64 readUInt(const Element &element);
+
+    void parseSeekHead(const Element &seekHead);
+    void parseInfo(const Element &info);
+    void parseTracks(const Element &tracks);
+    void parseContentEncodings(const QByteArray &data, int begin, int end, Track *track);
+    void parseCues(const Element &cues, QVector<CueRef> *refs);
+
+    bool clusterAt(qint64 pos, ClusterInfo *cluster);
+    qint64 scanCluster(const Element &cluster);
+    bool blockHeader(const Element &block, int *headerLength, qint16 *relative);
+    void readBlock(const Element &block, qint64 clusterTime, qint64 duration);
+    void readBlockGroup(const Element &group, qint64 clusterTime, qint64 duration);
+
+    QString frameText(QByteArray frame) const;
+    void setError(const QString &error);
+
+    QIODevice *m_device = nullptr;
+    QVector<EmbeddedSubtitles::Sample> *m_samples = nullptr;
+    QString m_errorString;
+    qint64 m_bytesRead = 0;
+
+    qint64 m_segmentPos = 0;
+    qint64 m_segmentEnd = 0;
+    quint64 m_timecodeScale = 1000000;
+    QHash<quint32, qint64> m_seek;  //element id -> absolute position
+    QVector<Track> m_tracks;
+    Track m_track;
+    QHash<qint64, ClusterInfo> m_clusters;
+
+    //read-ahead buffer, only used while walking clusters
+    bool m_readAhead = false;
+    QByteArray m_buffer;
+    qint64 m_bufferPos = 0;
+};
+
+#endif // MATROSKAREADER_H
@@ -0,0 +1,301 @@
+#include "mediascanner.h"
+
+#include "cuecache.h"
+#include "embeddedsubtitles.h"
+#include "logging.h"
+#include "subtitleloader.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QRegularExpression>
+#include <QSharedPointer>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+
+namespace {
+
+struct Candidate
+{
+    QString path;
+    QString base;       //lower-case name without the subtitle suffix
+    QString folder;     //lower-case name of the containing folder
+    int format;         //index into SubtitleLoader::suffixes()
+    bool sameFolder;
+};
+
+bool isSubsFolder(const QString &name)
+{
+    return name.compare(QLatin1String("subs"), Qt::CaseInsensitive) == 0
+            || name.compare(QLatin1String("subtitles"), Qt::CaseInsensitive) == 0;
+}
+
+void addCandidates(const QDir &dir, bool sameFolder, QVector<Candidate> *candidates)
+{
+    const QStringList suffixes = SubtitleLoader::suffixes();
+    const QString folder = dir.dirName().toLower();
+
+    for (const QFileInfo &file : dir.entryInfoList(SubtitleLoader::nameFilters(), QDir::Files))
+    {
+        const int format = suffixes.indexOf(file.suffix().toLower());
+        if (format >= 0)
+        {
+            candidates->push_back({file.filePath(), file.completeBaseName().toLower(), folder, format, sameFolder});
+        }
+    }
+}
+
+//higher is better; 0 means the file does not belong to the media
+int score(const Candidate &candidate, const QString &base, bool onlyMedia)
+{
+    QString tag;
+    if (candidate.base == base)
+    {
+        tag = QString();
+    }
+    else if (candidate.base.startsWith(base + '.'))
+    {
+        tag = candidate.base.mid(base.size() + 1);
+    }
+    else if (!candidate.sameFolder && (candidate.folder == base || onlyMedia))
+    {
+        //Subs/<base>/2_English.srt, or a Subs/ folder next to a single video
+        tag = candidate.base;
+    }
+    else
+    {
+        return 0;
+    }
+
+    static const QRegularExpression separators(QStringLiteral("[._\\- ]+"));
+    QStringList tokens = tag.split(separators);
+    tokens.removeAll(QString());
+
+    int language = tag.isEmpty() ? 3 : 1;
+    for (const QString &token : tokens)
+    {
+        if (token == QLatin1String("en") || token == QLatin1String("eng") || token == QLatin1String("english"))
+        {
+            language = 4;
+        }
+    }
+
+    //forced tracks only cover foreign-language lines
+    if (tokens.contains(QStringLiteral("forced")))
+    {
+        language -= 2;
+    }
+
+    return qMax(1, language * 10 + (candidate.sameFolder ? 5 : 0) - candidate.format);
+}
+
+} // namespace
+
+MediaScanner::MediaScanner(QObject *parent)
+    : QObject(parent)
+{
+}
+
+QStringList MediaScanner::mediaSuffixes()
+{
+    return {"mkv", "mp4", "avi", "m4v", "mov", "webm"};
+}
+
+void MediaScanner::scanFiles(const QStringList &mediaFiles)
+{
+    //pairing lists folders, so it stays off the GUI thread too
+    auto watcher = new QFutureWatcher<QVector<Pair>>(this);
+    connect(watcher, &QFutureWatcher<QVector<Pair>>::finished, this, [this, watcher]()
+    {
+        watcher->deleteLater();
+        parse(watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run(&MediaScanner::pair, mediaFiles));
+}
+
+void MediaScanner::scanDirectories(const QStringList &directories)
+{
+    auto watcher = new QFutureWatcher<QStringList>(this);
+    connect(watcher, &QFutureWatcher<QStringList>::finished, this, [this, watcher]()
+    {
+        watcher->deleteLater();
+
+        const QStringList mediaFiles = watcher->result();
+        if (!mediaFiles.isEmpty())
+        {
+            emit mediaFound(mediaFiles);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run(&MediaScanner::walk, directories));
+}
+
+QStringList MediaScanner::walk(const QStringList &directories)
+{
+    QStringList filters;
+    for (const QString &suffix : mediaSuffixes())
+    {
+        filters.push_back("*." + suffix);
+    }
+
+    QStringList mediaFiles;
+    for (const QString &directory : directories)
+    {
+        QDirIterator it(directory, filters, QDir::Files, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+        while (it.hasNext())
+        {
+            mediaFiles.push_back(it.next());
+        }
+    }
+
+    //episode order within each folder
+    std::sort(mediaFiles.begin(), mediaFiles.end(), [](const QString &a, const QString &b)
+    {
+        return QString::compare(a, b, Qt::CaseInsensitive) < 0;
+    });
+    mediaFiles.erase(std::unique(mediaFiles.begin(), mediaFiles.end()), mediaFiles.end());
+
+    return mediaFiles;
+}
+
+QVector<MediaScanner::Pair> MediaScanner::pair(const QStringList &mediaFiles)
+{
+    QHash<QString, QStringList> folders;
+    for (const QString &mediaFile : mediaFiles)
+    {
+        folders[QFileInfo(mediaFile).absolutePath()].push_back(mediaFile);
+    }
+
+    QHash<QString, QString> subtitleOf;
+    for (auto folder = folders.cbegin(); folder != folders.cend(); ++folder)
+    {
+        //one listing per folder and subtitle subfolder, shared by all its media
+        const QDir dir(folder.key());
+        QVector<Candidate> candidates;
+        addCandidates(dir, true, &candidates);
+
+        for (const QString &name : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+        {
+            if (!isSubsFolder(name))
+            {
+                continue;
+            }
+
+            const QDir subs(dir.filePath(name));
+            addCandidates(subs, false, &candidates);
+            for (const QString &inner : subs.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+            {
+                addCandidates(QDir(subs.filePath(inner)), false, &candidates);
+            }
+        }
+
+        //a lone video may claim any subtitle in Subs/; only count what could be ours
+        int mediaInFolder = 0;
+        for (const QString &name : dir.entryList(QDir::Files))
+        {
+            if (mediaSuffixes().contains(QFileInfo(name).suffix().toLower()))
+            {
+                ++mediaInFolder;
+            }
+        }
+
+        for (const QString &mediaFile : folder.value())
+        {
+            const QString base = QFileInfo(mediaFile).completeBaseName().toLower();
+
+            int best = 0;
+            for (const Candidate &candidate : candidates)
+            {
+                const int value = score(candidate, base, mediaInFolder <= 1);
+                if (value > best)
+                {
+                    best = value;
+                    subtitleOf.insert(mediaFile, candidate.path);
+                }
+            }
+        }
+    }
+
+    QVector<Pair> pairs;
+    pairs.reserve(mediaFiles.size());
+    for (const QString &mediaFile : mediaFiles)
+    {
+        pairs.push_back({mediaFile, subtitleOf.value(mediaFile)});
+    }
+    return pairs;
+}
+
+MediaScanner::Result MediaScanner::load(const Pair &pair)
+{
+    Result result;
+    result.media = pair.media;
+
+    QString errorString;
+    if (!pair.subtitle.isEmpty())
+    {
+        result.cues = SubtitleLoader::loadFile(pair.subtitle, &errorString);
+        result.subtitle = pair.subtitle;
+    }
+    else if (EmbeddedSubtitles::canRead(pair.media))
+    {
+        //extracted tracks are cached under the media file itself
+        const CueCache cache;
+        if (!cache.load(pair.media, &result.cues))
+        {
+            result.cues = EmbeddedSubtitles::read(pair.media, &errorString);
+            if (!result.cues.isEmpty())
+            {
+                cache.store(pair.media, result.cues);
+            }
+        }
+
+        if (!result.cues.isEmpty())
+        {
+            result.subtitle = pair.media;
+        }
+    }
+
+    if (!errorString.isEmpty())
+    {
+        qCInfo(lcScanner) << "No subtitles for" << pair.media << ":" << errorString;
+    }
+
+    return result;
+}
+
+void MediaScanner::parse(const QVector<Pair> &pairs)
+{
+    if (pairs.isEmpty())
+    {
+        emit scanFinished(0, 0);
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QSharedPointer<int> missing(new int(0));
+
+    auto watcher = new QFutureWatcher<Result>(this);
+    connect(watcher, &QFutureWatcher<Result>::resultReadyAt, this, [this, watcher, missing](int index)
+    {
+        const Result result = watcher->resultAt(index);
+        if (result.cues.isEmpty())
+        {
+            ++*missing;
+        }
+        emit mediaScanned(result);
+    });
+    const int count = pairs.size();
+    connect(watcher, &QFutureWatcher<Result>::finished, this, [this, watcher, missing, timer, count]()
+    {
+        watcher->deleteLater();
+
+        qCInfo(lcScanner) << "Scanned" << count << "media files in" << timer.elapsed() << "ms," << *missing << "without subtitles";
+        emit scanFinished(count, *missing);
+    });
+    watcher->setFuture(QtConcurrent::mapped(pairs, &MediaScanner::load));
+}
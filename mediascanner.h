@@ -0,0 +1,58 @@
+#ifndef MEDIASCANNER_H
+#define MEDIASCANNER_H
+
+#include "cuetable.h"
+
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+//Finds and parses the subtitles of media files on the thread pool.
+//Files are grouped by folder so each folder (and its Subs/ or Subtitles/
+//subfolders) is listed once. A media file pairs with "<base>.srt",
+//"<base>.<lang>.srt", "Subs/<base>*.srt" or "Subs/<base>/*.srt" (any
+//supported subtitle suffix), English over other languages, full over
+//forced tracks; files with no match fall back to an embedded track.
+//Each result is delivered as soon as it is parsed.
+class MediaScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Result
+    {
+        QString media;
+        QString subtitle;   //subtitle file, the media file for embedded tracks, or empty
+        CueTable cues;
+    };
+
+    struct Pair
+    {
+        QString media;
+        QString subtitle;
+    };
+
+    explicit MediaScanner(QObject *parent = nullptr);
+
+    static QStringList mediaSuffixes();
+
+    //blocking steps of a scan, for batch callers that run their own pool
+    static QStringList walk(const QStringList &directories);
+    static QVector<Pair> pair(const QStringList &mediaFiles);
+    static Result load(const Pair &pair);
+
+    void scanFiles(const QStringList &mediaFiles);
+    //only lists the media; the caller decides which of it to scanFiles()
+    void scanDirectories(const QStringList &directories);
+
+signals:
+    //media found under scanned directories
+    void mediaFound(const QStringList &mediaFiles);
+    void mediaScanned(const MediaScanner::Result &result);
+    void scanFinished(int mediaFiles, int withoutSubtitles);
+
+private:
+    void parse(const QVector<Pair> &pairs);
+};
+
+#endif // MEDIASCANNER_H
@@ -0,0 +1,265 @@
+#include "mockdictionarynetwork.h"
+
+#include "dictionarybackend.h"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <QUrl>
+
+namespace {
+
+//Serves one canned answer after a delay, like a reply read off the wire.
+class MockReply : public QNetworkReply
+{
+public:
+    MockReply(const QNetworkRequest &request, QNetworkAccessManager::Operation op, QObject *parent)
+        : QNetworkReply(parent)
+    {
+        setRequest(request);
+        setUrl(request.url());
+        setOperation(op);
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+
+    void respond(int delay, int status, const QByteArray &body, const QByteArray &retryAfter = QByteArray())
+    {
+        QTimer::singleShot(delay, this, [this, status, body, retryAfter]()
+        {
+            if (isFinished())
+            {
+                return;
+            }
+
+            m_body = body;
+            setAttribute(QNetworkRequest::HttpStatusCodeAttribute, status);
+            setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+            setHeader(QNetworkRequest::ContentLengthHeader, body.size());
+            if (!retryAfter.isEmpty())
+            {
+                setRawHeader("Retry-After", retryAfter);
+            }
+
+            //the errors QNetworkReply reports for these status codes
+            if (status == 404)
+            {
+                setError(ContentNotFoundError, "Not Found");
+            }
+            else if (status == 503)
+            {
+                setError(ServiceUnavailableError, "Service Unavailable");
+            }
+            else if (status >= 400)
+            {
+                setError(UnknownContentError, "Too Many Requests");
+            }
+
+            emit metaDataChanged();
+            finish();
+        });
+    }
+
+    void abort() override
+    {
+        if (isFinished())
+        {
+            return;
+        }
+
+        setError(OperationCanceledError, "Operation canceled");
+        finish();
+    }
+
+    bool isSequential() const override
+    {
+        return true;
+    }
+
+    qint64 bytesAvailable() const override
+    {
+        return m_body.size() - m_read + QNetworkReply::bytesAvailable();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        const qint64 count = qMin<qint64>(maxSize, m_body.size() - m_read);
+        memcpy(data, m_body.constData() + m_read, size_t(count));
+        m_read += count;
+        return count;
+    }
+
+private:
+    void finish()
+    {
+        setFinished(true);
+        if (!m_body.isEmpty())
+        {
+            emit readyRead();
+        }
+        emit finished();
+    }
+
+    QByteArray m_body;
+    qint64 m_read = 0;
+};
+
+QByteArray synthesizedAnswer(const QString &word)
+{
+    QJsonObject sense_obj;
+    sense_obj["definitions"] = QJsonArray{"Stand-in definition of " + word + "."};
+    sense_obj["examples"] = QJsonArray{QJsonObject{{"text", "An example with " + word + " in it."}}};
+
+    QJsonObject entry_obj;
+    entry_obj["senses"] = QJsonArray{sense_obj};
+
+    QJsonObject lexEntry_obj;
+    lexEntry_obj["lexicalCategory"] = QJsonObject{{"text", "Noun"}};
+    lexEntry_obj["entries"] = QJsonArray{entry_obj};
+
+    QJsonObject results_obj;
+    results_obj["id"] = word;
+    results_obj["lexicalEntries"] = QJsonArray{lexEntry_obj};
+
+    return QJsonDocument(QJsonObject{{"results", QJsonArray{results_obj}}}).toJson(QJsonDocument::Compact);
+}
+
+} // namespace
+
+MockDictionaryNetwork::MockDictionaryNetwork(QObject *parent)
+    : QNetworkAccessManager(parent)
+{
+    m_clock.start();
+}
+
+void MockDictionaryNetwork::setOptions(const Options &options)
+{
+    m_options = options;
+}
+
+void MockDictionaryNetwork::setBackend(DictionaryBackend *backend)
+{
+    m_backend = backend;
+}
+
+int MockDictionaryNetwork::loadRecordings(const QString &directory)
+{
+    //<directory>/<language>/<word>.json, as saved from the real API
+    QDirIterator it(directory, QStringList() << "*.json", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        const QFileInfo info(it.next());
+        m_recordings.insert(info.dir().dirName() + '/' + info.completeBaseName().toLower(), info.filePath());
+    }
+    return m_recordings.size();
+}
+
+QStringList MockDictionaryNetwork::recordedWords(const QString &language) const
+{
+    QStringList words;
+    const QString prefix = language + '/';
+    for (auto it = m_recordings.constBegin(); it != m_recordings.constEnd(); ++it)
+    {
+        if (it.key().startsWith(prefix))
+        {
+            words.push_back(it.key().mid(prefix.size()));
+        }
+    }
+    words.sort();
+    return words;
+}
+
+bool MockDictionaryNetwork::isThrottled()
+{
+    if (m_options.rateLimit <= 0)
+    {
+        return false;
+    }
+
+    //sliding one-second window, like a per-key quota on the real server
+    const qint64 now = m_clock.elapsed();
+    while (!m_recent.isEmpty() && now - m_recent.head() >= 1000)
+    {
+        m_recent.dequeue();
+    }
+
+    if (m_recent.size() >= m_options.rateLimit)
+    {
+        return true;
+    }
+    m_recent.enqueue(now);
+    return false;
+}
+
+QNetworkReply *MockDictionaryNetwork::createRequest(Operation op, const QNetworkRequest &request,
+                                                    QIODevice *outgoingData)
+{
+    Q_UNUSED(outgoingData);
+
+    ++m_stats.requests;
+
+    MockReply *reply = new MockReply(request, op, this);
+
+    QRandomGenerator *random = QRandomGenerator::global();
+    const int delay = m_options.latency + (m_options.jitter > 0 ? int(random->bounded(m_options.jitter + 1)) : 0);
+
+    if (isThrottled())
+    {
+        ++m_stats.throttled;
+        reply->respond(delay, 429, QByteArray("{\"error\":\"Too Many Requests\"}"), "1");
+        return reply;
+    }
+
+    if (m_options.errorRate > 0 && random->generateDouble() < m_options.errorRate)
+    {
+        ++m_stats.errors;
+        reply->respond(delay, 503, QByteArray("{\"error\":\"Service Unavailable\"}"));
+        return reply;
+    }
+
+    //.../entries/<language>/<word>; QString::SkipEmptyParts is deprecated
+    //and Qt::SkipEmptyParts needs 5.14, so empty parts are dropped here
+    QStringList path = request.url().path().split('/');
+    path.removeAll(QString());
+    const QString language = path.size() >= 2 ? path.at(path.size() - 2) : QString();
+    const QString word = path.isEmpty() ? QString() : QUrl::fromPercentEncoding(path.last().toUtf8());
+
+    QByteArray answer;
+    const QString recording = m_recordings.value(language + '/' + word.toLower());
+    if (!recording.isEmpty())
+    {
+        QFile file(recording);
+        if (file.open(QIODevice::ReadOnly))
+        {
+            answer = file.readAll();
+            ++m_stats.recorded;
+        }
+    }
+
+    if (answer.isEmpty() && m_backend && m_backend->lookup(language, word, &answer))
+    {
+        ++m_stats.recorded;
+    }
+
+    if (answer.isEmpty() && m_options.synthesize && !word.isEmpty())
+    {
+        answer = synthesizedAnswer(word);
+        ++m_stats.synthesized;
+    }
+
+    if (answer.isEmpty())
+    {
+        ++m_stats.notFound;
+        reply->respond(delay, 404, QByteArray("{\"error\":\"No entry found\"}"));
+        return reply;
+    }
+
+    reply->respond(delay, 200, answer);
+    return reply;
+}
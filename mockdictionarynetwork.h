@@ -0,0 +1,69 @@
+#ifndef MOCKDICTIONARYNETWORK_H
+#define MOCKDICTIONARYNETWORK_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QQueue>
+#include <QStringList>
+
+class DictionaryBackend;
+
+//Stand-in for the Oxford Dictionaries server, in process.
+//Every request made through this manager is answered locally: recorded
+//"entries" responses (<folder>/<language>/<word>.json) first, then an
+//optional dictionary backend, then a synthesized one-sense entry (or 404
+//when synthesizing is off). Latency, server errors and a per-second
+//request limit (answered with 429) are configurable, so the lookup
+//pipeline can be exercised and timed without the network.
+class MockDictionaryNetwork : public QNetworkAccessManager
+{
+    Q_OBJECT
+
+public:
+    struct Options
+    {
+        int latency = 80;           //ms before an answer
+        int jitter = 40;            //up to this many ms more
+        double errorRate = 0;       //fraction answered with 503
+        int rateLimit = 0;          //requests per second before 429, 0 = none
+        bool synthesize = true;     //invent entries for unknown words
+    };
+
+    struct Stats
+    {
+        quint64 requests = 0;
+        quint64 recorded = 0;
+        quint64 synthesized = 0;
+        quint64 notFound = 0;
+        quint64 errors = 0;
+        quint64 throttled = 0;
+    };
+
+    explicit MockDictionaryNetwork(QObject *parent = nullptr);
+
+    void setOptions(const Options &options);
+    void setBackend(DictionaryBackend *backend);
+
+    //returns the number of recordings found
+    int loadRecordings(const QString &directory);
+    QStringList recordedWords(const QString &language) const;
+
+    Stats stats() const { return m_stats; }
+
+protected:
+    QNetworkReply *createRequest(Operation op, const QNetworkRequest &request,
+                                 QIODevice *outgoingData = nullptr) override;
+
+private:
+    bool isThrottled();
+
+    Options m_options;
+    DictionaryBackend *m_backend = nullptr;
+    QHash<QString, QString> m_recordings;  //"language/word" -> file
+    QElapsedTimer m_clock;
+    QQueue<qint64> m_recent;               //request times in the last second
+    Stats m_stats;
+};
+
+#endif // MOCKDICTIONARYNETWORK_H
@@ -0,0 +1,511 @@
+#include "mp4reader.h"
+
+#include <QIODevice>
+#include <QtEndian>
+
+namespace {
+
+const qint64 MaxMoovSize = 256 * 1024 * 1024;
+const qint64 MaxChunkSize = 4 * 1024 * 1024;
+
+constexpr quint32 tag(const char (&name)[5])
+{
+    return (quint32(quint8(name[0])) << 24) | (quint32(quint8(name[1])) << 16)
+            | (quint32(quint8(name[2])) << 8) | quint32(quint8(name[3]));
+}
+
+inline quint32 be32(const char *data)
+{
+    return qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(data));
+}
+
+inline quint64 be64(const char *data)
+{
+    return qFromBigEndian<quint64>(reinterpret_cast<const uchar *>(data));
+}
+
+//boxes of a container held in memory
+class Boxes
+{
+public:
+    Boxes(const QByteArray &data, int begin, int end)
+        : m_data(data)
+        , m_next(begin)
+        , m_end(end)
+    {
+    }
+
+    bool next()
+    {
+        if (m_next + 8 > m_end)
+        {
+            return false;
+        }
+
+        const char *header = m_data.constData() + m_next;
+        quint64 size = be32(header);
+        int headerLength = 8;
+        if (size == 1)
+        {
+            if (m_next + 16 > m_end)
+            {
+                return false;
+            }
+            size = be64(header + 8);
+            headerLength = 16;
+        }
+        else if (size == 0)
+        {
+            size = quint64(m_end - m_next);
+        }
+
+        if (size < quint64(headerLength) || size > quint64(m_end - m_next))
+        {
+            return false;
+        }
+
+        m_type = be32(header + 4);
+        m_begin = m_next + headerLength;
+        m_next += int(size);
+        return true;
+    }
+
+    quint32 type() const { return m_type; }
+    int begin() const { return m_begin; }
+    int end() const { return m_next; }
+    int size() const { return m_next - m_begin; }
+
+private:
+    const QByteArray &m_data;
+    int m_next;
+    int m_end;
+    quint32 m_type = 0;
+    int m_begin = 0;
+};
+
+//entry count of a full box table, clamped to what actually fits
+quint32 tableSize(const QByteArray &data, const Boxes &box, int headerLength, int entryLength)
+{
+    if (box.size() < headerLength)
+    {
+        return 0;
+    }
+
+    const quint32 count = be32(data.constData() + box.begin() + headerLength - 4);
+    return qMin(count, quint32((box.size() - headerLength) / entryLength));
+}
+
+} // namespace
+
+Mp4Reader::Mp4Reader(QIODevice *device)
+    : m_device(device)
+{
+}
+
+bool Mp4Reader::read(QVector<EmbeddedSubtitles::Sample> *samples)
+{
+    m_samples = samples;
+
+    QByteArray moov;
+    if (!findMoov(&moov))
+    {
+        setError(QStringLiteral("MP4 movie header not found"));
+        return false;
+    }
+
+    parseMvhd(moov);
+
+    //prefer an English track, otherwise the first text track
+    bool found = false;
+    Boxes traks(moov, 0, moov.size());
+    while (traks.next())
+    {
+        if (traks.type() != tag("trak"))
+        {
+            continue;
+        }
+
+        Track track;
+        parseTrak(moov, traks.begin(), traks.end(), &track);
+
+        const bool text = track.format == "tx3g" || track.format == "wvtt" || track.format == "text";
+        if (!text || track.timescale == 0 || track.chunkOffsets.isEmpty())
+        {
+            continue;
+        }
+
+        if (!found || (track.language == "eng" && m_track.language != "eng"))
+        {
+            m_track = track;
+            found = true;
+        }
+    }
+
+    if (!found)
+    {
+        setError(QStringLiteral("No text subtitle track"));
+        return false;
+    }
+
+    readSamples(m_track);
+    return true;
+}
+
+bool Mp4Reader::findMoov(QByteArray *moov)
+{
+    //top-level boxes are skipped by header only; mdat is usually most of the file
+    const qint64 fileSize = m_device->size();
+    qint64 pos = 0;
+
+    while (pos + 8 <= fileSize)
+    {
+        char header[16];
+        if (!m_device->seek(pos) || m_device->read(header, sizeof(header)) < 8)
+        {
+            return false;
+        }
+        m_bytesRead += sizeof(header);
+
+        qint64 size = be32(header);
+        qint64 headerLength = 8;
+        if (size == 1)
+        {
+            size = qint64(be64(header + 8));
+            headerLength = 16;
+        }
+        else if (size == 0)
+        {
+            size = fileSize - pos;
+        }
+
+        if (size < headerLength)
+        {
+            return false;
+        }
+
+        if (be32(header + 4) == tag("moov"))
+        {
+            const qint64 payload = qMin(size, fileSize - pos) - headerLength;
+            if (payload > MaxMoovSize || !m_device->seek(pos + headerLength))
+            {
+                return false;
+            }
+
+            moov->resize(int(payload));
+            if (m_device->read(moov->data(), payload) != payload)
+            {
+                return false;
+            }
+            m_bytesRead += payload;
+            return true;
+        }
+
+        pos += size;
+    }
+
+    return false;
+}
+
+void Mp4Reader::parseMvhd(const QByteArray &moov)
+{
+    Boxes boxes(moov, 0, moov.size());
+    while (boxes.next())
+    {
+        if (boxes.type() == tag("mvhd") && boxes.size() >= 16)
+        {
+            //version 1 widens the times to 64 bits
+            const char *data = moov.constData() + boxes.begin();
+            const bool wide = data[0] == 1 && boxes.size() >= 24;
+            m_movieTimescale = be32(data + (wide ? 20 : 12));
+            return;
+        }
+    }
+}
+
+void Mp4Reader::parseTrak(const QByteArray &moov, int begin, int end, Track *track)
+{
+    Boxes trak(moov, begin, end);
+    while (trak.next())
+    {
+        if (trak.type() == tag("edts"))
+        {
+            Boxes edts(moov, trak.begin(), trak.end());
+            while (edts.next())
+            {
+                if (edts.type() == tag("elst"))
+                {
+                    parseElst(moov, edts.begin(), edts.end(), track);
+                }
+            }
+            continue;
+        }
+
+        if (trak.type() != tag("mdia"))
+        {
+            continue;
+        }
+
+        Boxes mdia(moov, trak.begin(), trak.end());
+        while (mdia.next())
+        {
+            if (mdia.type() == tag("mdhd") && mdia.size() >= 24)
+            {
+                //version 1 widens the times to 64 bits
+                const char *data = moov.constData() + mdia.begin();
+                const bool wide = data[0] == 1 && mdia.size() >= 36;
+                track->timescale = be32(data + (wide ? 20 : 12));
+
+                const quint16 packed = qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(data + (wide ? 32 : 20)));
+                track->language.resize(3);
+                track->language[0] = char(((packed >> 10) & 0x1F) + 0x60);
+                track->language[1] = char(((packed >> 5) & 0x1F) + 0x60);
+                track->language[2] = char((packed & 0x1F) + 0x60);
+            }
+            else if (mdia.type() == tag("minf"))
+            {
+                Boxes minf(moov, mdia.begin(), mdia.end());
+                while (minf.next())
+                {
+                    if (minf.type() == tag("stbl"))
+                    {
+                        parseStbl(moov, minf.begin(), minf.end(), track);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Mp4Reader::parseElst(const QByteArray &moov, int begin, int end, Track *track)
+{
+    if (end - begin < 8)
+    {
+        return;
+    }
+
+    //entries: segment duration, media time (-1 for an empty edit), rate;
+    //only where the track starts matters for subtitles, so leading empty
+    //edits add a delay and the first real edit sets the media start
+    const char *data = moov.constData() + begin;
+    const bool wide = data[0] == 1;
+    const int entryLength = wide ? 20 : 12;
+    const quint32 count = qMin(be32(data + 4), quint32((end - begin - 8) / entryLength));
+
+    for (quint32 i = 0; i < count; ++i)
+    {
+        const char *entry = data + 8 + i * entryLength;
+        const quint64 duration = wide ? be64(entry) : be32(entry);
+        const qint64 mediaTime = wide ? qint64(be64(entry + 8)) : qint64(qint32(be32(entry + 4)));
+
+        if (mediaTime < 0)
+        {
+            track->emptyEdit += duration;
+            continue;
+        }
+
+        track->mediaStart = mediaTime;
+        return;
+    }
+}
+
+void Mp4Reader::parseStbl(const QByteArray &moov, int begin, int end, Track *track)
+{
+    Boxes stbl(moov, begin, end);
+    while (stbl.next())
+    {
+        const char *data = moov.constData() + stbl.begin();
+        const quint32 type = stbl.type();
+
+        if (type == tag("stsd") && stbl.size() >= 16)
+        {
+            //format of the first sample entry
+            track->format = QByteArray(data + 12, 4);
+        }
+        else if (type == tag("stts"))
+        {
+            const quint32 count = tableSize(moov, stbl, 8, 8);
+            track->timeCounts.resize(int(count));
+            track->timeDeltas.resize(int(count));
+            for (quint32 i = 0; i < count; ++i)
+            {
+                track->timeCounts[int(i)] = be32(data + 8 + i * 8);
+                track->timeDeltas[int(i)] = be32(data + 12 + i * 8);
+            }
+        }
+        else if (type == tag("stsc"))
+        {
+            const quint32 count = tableSize(moov, stbl, 8, 12);
+            track->chunkFirst.resize(int(count));
+            track->chunkSamples.resize(int(count));
+            for (quint32 i = 0; i < count; ++i)
+            {
+                track->chunkFirst[int(i)] = be32(data + 8 + i * 12);
+                track->chunkSamples[int(i)] = be32(data + 12 + i * 12);
+            }
+        }
+        else if (type == tag("stsz") && stbl.size() >= 12)
+        {
+            track->sampleSize = be32(data + 4);
+            track->sampleCount = be32(data + 8);
+            if (track->sampleSize == 0)
+            {
+                const quint32 count = tableSize(moov, stbl, 12, 4);
+                track->sampleCount = count;
+                track->sampleSizes.resize(int(count));
+                for (quint32 i = 0; i < count; ++i)
+                {
+                    track->sampleSizes[int(i)] = be32(data + 12 + i * 4);
+                }
+            }
+        }
+        else if (type == tag("stco") || type == tag("co64"))
+        {
+            const int width = type == tag("co64") ? 8 : 4;
+            const quint32 count = tableSize(moov, stbl, 8, width);
+            track->chunkOffsets.resize(int(count));
+            for (quint32 i = 0; i < count; ++i)
+            {
+                const char *entry = data + 8 + i * width;
+                track->chunkOffsets[int(i)] = width == 8 ? be64(entry) : be32(entry);
+            }
+        }
+    }
+}
+
+void Mp4Reader::readSamples(const Track &track)
+{
+    int timeEntry = 0;
+    quint32 timeLeft = track.timeCounts.isEmpty() ? 0 : track.timeCounts.at(0);
+    quint64 time = 0;
+
+    int chunkEntry = 0;
+    quint32 sample = 0;
+    QByteArray chunk;
+
+    //media time to presentation time, in ms
+    qint64 editOffset = -qint64(quint64(track.mediaStart) * 1000 / track.timescale);
+    if (m_movieTimescale > 0)
+    {
+        editOffset += qint64(track.emptyEdit * 1000 / m_movieTimescale);
+    }
+
+    for (int c = 0; c < track.chunkOffsets.size() && sample < track.sampleCount; ++c)
+    {
+        while (chunkEntry + 1 < track.chunkFirst.size() && track.chunkFirst.at(chunkEntry + 1) <= quint32(c + 1))
+        {
+            ++chunkEntry;
+        }
+
+        const quint32 perChunk = qMin(track.chunkFirst.isEmpty() ? 1u : track.chunkSamples.at(chunkEntry),
+                                      track.sampleCount - sample);
+
+        //samples of a chunk are contiguous, so each chunk is one read
+        qint64 chunkSize = 0;
+        for (quint32 k = 0; k < perChunk; ++k)
+        {
+            chunkSize += track.sampleSize ? track.sampleSize : track.sampleSizes.at(int(sample + k));
+        }
+
+        const qint64 offset = qint64(track.chunkOffsets.at(c));
+        bool readOk = chunkSize <= MaxChunkSize && m_device->seek(offset);
+        if (readOk)
+        {
+            chunk.resize(int(chunkSize));
+            readOk = m_device->read(chunk.data(), chunkSize) == chunkSize;
+            m_bytesRead += chunkSize;
+        }
+
+        qint64 within = 0;
+        for (quint32 k = 0; k < perChunk; ++k, ++sample)
+        {
+            const quint32 size = track.sampleSize ? track.sampleSize : track.sampleSizes.at(int(sample));
+
+            while (timeLeft == 0 && timeEntry + 1 < track.timeCounts.size())
+            {
+                timeLeft = track.timeCounts.at(++timeEntry);
+            }
+            const quint32 delta = track.timeDeltas.isEmpty() ? 0 : track.timeDeltas.at(timeEntry);
+            if (timeLeft > 0)
+            {
+                --timeLeft;
+            }
+
+            if (readOk && size > 0)
+            {
+                EmbeddedSubtitles::Sample cue;
+                cue.start = qint64(time * 1000 / track.timescale) + editOffset;
+                cue.end = qint64((time + delta) * 1000 / track.timescale) + editOffset;
+                cue.text = sampleText(chunk.constData() + within, int(size));
+
+                //empty samples only clear the previous cue; samples cut
+                //off by the edit list are never shown
+                if (!cue.text.isEmpty() && cue.end > 0)
+                {
+                    m_samples->push_back(cue);
+                }
+            }
+
+            time += delta;
+            within += size;
+        }
+    }
+}
+
+QString Mp4Reader::sampleText(const char *data, int size) const
+{
+    if (m_track.format == "wvtt")
+    {
+        //each vttc box carries one cue's payload; vtte marks a gap
+        const QByteArray sample = QByteArray::fromRawData(data, size);
+        QString text;
+        Boxes boxes(sample, 0, size);
+        while (boxes.next())
+        {
+            if (boxes.type() != tag("vttc"))
+            {
+                continue;
+            }
+
+            Boxes cue(sample, boxes.begin(), boxes.end());
+            while (cue.next())
+            {
+                if (cue.type() == tag("payl"))
+                {
+                    if (!text.isEmpty())
+                    {
+                        text += QLatin1Char('\n');
+                    }
+                    text += QString::fromUtf8(data + cue.begin(), cue.size());
+                }
+            }
+        }
+        return text;
+    }
+
+    //tx3g: 16-bit length, then UTF-8 or BOM-marked UTF-16 text, then style boxes
+    if (size < 2)
+    {
+        return QString();
+    }
+
+    const int length = qMin(int(qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(data))), size - 2);
+    const uchar *text = reinterpret_cast<const uchar *>(data + 2);
+
+    if (length >= 2 && text[0] == 0xFE && text[1] == 0xFF)
+    {
+        QString utf16;
+        utf16.reserve(length / 2);
+        for (int i = 2; i + 1 < length; i += 2)
+        {
+            utf16 += QChar(ushort((text[i] << 8) | text[i + 1]));
+        }
+        return utf16;
+    }
+
+    return QString::fromUtf8(data + 2, length);
+}
+
+void Mp4Reader::setError(const QString &error)
+{
+    m_errorString = error;
+}
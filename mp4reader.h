@@ -0,0 +1,65 @@
+#ifndef MP4READER_H
+#define MP4READER_H
+
+#include "embeddedsubtitles.h"
+
+#include <QByteArray>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+//Pulls the text subtitle track (tx3g or wvtt) out of an MP4/MOV file.
+//Only the moov box is loaded; the sample tables give the offset, size and
+//time of every subtitle sample, which are then read chunk by chunk.
+//The start of the edit list (elst) is honoured: a leading empty edit
+//delays the track and the first edit's media time is where it starts.
+//Fragmented files (moof) are not handled.
+class Mp4Reader
+{
+public:
+    explicit Mp4Reader(QIODevice *device);
+
+    bool read(QVector<EmbeddedSubtitles::Sample> *samples);
+
+    QString errorString() const { return m_errorString; }
+    QString codec() const { return QString::fromLatin1(m_track.format); }
+    QString language() const { return QString::fromLatin1(m_track.language); }
+    qint64 bytesRead() const { return m_bytesRead; }
+
+private:
+    struct Track
+    {
+        QByteArray format;
+        QByteArray language;
+        quint32 timescale = 0;
+        quint64 emptyEdit = 0;          //elst, in movie timescale units
+        qint64 mediaStart = 0;          //elst, in track timescale units
+        QVector<quint32> timeCounts;    //stts
+        QVector<quint32> timeDeltas;
+        QVector<quint32> chunkFirst;    //stsc, 1-based chunk numbers
+        QVector<quint32> chunkSamples;
+        quint32 sampleSize = 0;         //stsz, 0 when sizes vary
+        quint32 sampleCount = 0;
+        QVector<quint32> sampleSizes;
+        QVector<quint64> chunkOffsets;  //stco/co64
+    };
+
+    bool findMoov(QByteArray *moov);
+    void parseMvhd(const QByteArray &moov);
+    void parseTrak(const QByteArray &moov, int begin, int end, Track *track);
+    void parseElst(const QByteArray &moov, int begin, int end, Track *track);
+    void parseStbl(const QByteArray &moov, int begin, int end, Track *track);
+    void readSamples(const Track &track);
+    QString sampleText(const char *data, int size) const;
+    void setError(const QString &error);
+
+    QIODevice *m_device = nullptr;
+    QVector<EmbeddedSubtitles::Sample> *m_samples = nullptr;
+    QString m_errorString;
+    qint64 m_bytesRead = 0;
+    quint32 m_movieTimescale = 0;
+    Track m_track;
+};
+
+#endif // MP4READER_H
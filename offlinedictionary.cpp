@@ -0,0 +1,322 @@
+#include "offlinedictionary.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+//index layout (little endian):
+//  header  : magic[4] version:u32 count:u32 reserved:u32 blobOffset:u64
+//            dumpSize:u64 dumpModified:i64 (ms since epoch)
+//  records : count x {keyOffset:u32 keyLength:u32 valueOffset:u32 valueLength:u32}
+//            sorted by key bytes, offsets relative to blobOffset
+//  blob    : lower-cased UTF-8 keys and prebuilt JSON answers
+static const char INDEX_MAGIC[4] = {'V', 'I', 'D', 'X'};
+static const quint32 INDEX_VERSION = 2;
+static const int HEADER_SIZE = 40;
+static const int RECORD_SIZE = 16;
+
+namespace {
+
+struct Sense
+{
+    QString category;
+    QString definition;
+    QString example;
+};
+
+QByteArray buildAnswer(const QString &word, const QVector<Sense> &senses)
+{
+    //group senses by lexical category, in dump order
+    QStringList categories;
+    QMap<QString, QJsonArray> sensesByCategory;
+    for (const Sense &sense : senses)
+    {
+        if (!sensesByCategory.contains(sense.category))
+        {
+            categories.push_back(sense.category);
+        }
+
+        QJsonObject sense_obj;
+        sense_obj["definitions"] = QJsonArray{sense.definition};
+        if (!sense.example.isEmpty())
+        {
+            sense_obj["examples"] = QJsonArray{QJsonObject{{"text", sense.example}}};
+        }
+        sensesByCategory[sense.category].append(sense_obj);
+    }
+
+    QJsonArray lexicalEntries;
+    for (const QString &category : categories)
+    {
+        QJsonObject entry_obj;
+        entry_obj["senses"] = sensesByCategory.value(category);
+
+        QJsonObject lexEntry_obj;
+        lexEntry_obj["lexicalCategory"] = QJsonObject{{"text", category}};
+        lexEntry_obj["entries"] = QJsonArray{entry_obj};
+        lexicalEntries.append(lexEntry_obj);
+    }
+
+    QJsonObject results_obj;
+    results_obj["id"] = word;
+    results_obj["lexicalEntries"] = lexicalEntries;
+
+    return QJsonDocument(QJsonObject{{"results", QJsonArray{results_obj}}}).toJson(QJsonDocument::Compact);
+}
+
+inline void putU32(QByteArray &out, quint32 value)
+{
+    const quint32 le = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char *>(&le), sizeof(le));
+}
+
+inline quint32 getU32(const uchar *p)
+{
+    return qFromLittleEndian<quint32>(p);
+}
+
+//every key and answer must lie inside the blob; checked once at open()
+//so lookup() can trust the offsets of a truncated or corrupt index
+bool recordsInRange(const uchar *records, quint32 count, quint64 blobSize)
+{
+    for (quint32 i = 0; i < count; ++i)
+    {
+        const uchar *record = records + qint64(i) * RECORD_SIZE;
+        if (quint64(getU32(record)) + getU32(record + 4) > blobSize
+                || quint64(getU32(record + 8)) + getU32(record + 12) > blobSize
+                || getU32(record + 12) > quint32(std::numeric_limits<int>::max()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+OfflineDictionary::~OfflineDictionary()
+{
+    close();
+}
+
+QString OfflineDictionary::indexFileNameFor(const QString &dumpFileName)
+{
+    //dumps of the same name in different folders get their own index
+    const QByteArray hash = QCryptographicHash::hash(QFileInfo(dumpFileName).absoluteFilePath().toUtf8(),
+                                                     QCryptographicHash::Sha1);
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + "/offline/" + QString::fromLatin1(hash.toHex()) + ".vidx";
+}
+
+bool OfflineDictionary::import(const QString &dumpFileName, const QString &indexFileName, QString *errorString)
+{
+    //stamped before reading, so a dump changed meanwhile is rebuilt next time
+    const QFileInfo dumpInfo(dumpFileName);
+    const quint64 dumpSize = qToLittleEndian<quint64>(quint64(dumpInfo.size()));
+    const qint64 dumpModified = qToLittleEndian<qint64>(dumpInfo.lastModified().toMSecsSinceEpoch());
+
+    QFile dump(dumpFileName);
+    if (!dump.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        if (errorString)
+        {
+            *errorString = dump.errorString();
+        }
+        return false;
+    }
+
+    //QMap keeps the keys in byte order, which is the order lookup() searches in
+    QMap<QByteArray, QPair<QString, QVector<Sense>>> entries;
+
+    QTextStream in(&dump);
+    in.setCodec("UTF-8");
+    while (!in.atEnd())
+    {
+        const QString line = in.readLine();
+        if (line.isEmpty() || line.startsWith('#'))
+        {
+            continue;
+        }
+
+        const QVector<QStringRef> fields = line.splitRef('\t');
+        if (fields.size() < 3 || fields.at(0).trimmed().isEmpty())
+        {
+            continue;
+        }
+
+        const QString word = fields.at(0).trimmed().toString();
+        auto &entry = entries[word.toLower().toUtf8()];
+        if (entry.first.isEmpty())
+        {
+            entry.first = word;
+        }
+        entry.second.push_back({fields.at(1).trimmed().toString(),
+                                fields.at(2).trimmed().toString(),
+                                fields.size() > 3 ? fields.at(3).trimmed().toString() : QString()});
+    }
+
+    QByteArray records;
+    QByteArray blob;
+    records.reserve(entries.size() * RECORD_SIZE);
+
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it)
+    {
+        const QByteArray answer = buildAnswer(it.value().first, it.value().second);
+
+        putU32(records, quint32(blob.size()));
+        putU32(records, quint32(it.key().size()));
+        blob.append(it.key());
+
+        putU32(records, quint32(blob.size()));
+        putU32(records, quint32(answer.size()));
+        blob.append(answer);
+    }
+
+    QByteArray header(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    putU32(header, INDEX_VERSION);
+    putU32(header, quint32(entries.size()));
+    putU32(header, 0);
+    const quint64 blobOffset = qToLittleEndian<quint64>(HEADER_SIZE + records.size());
+    header.append(reinterpret_cast<const char *>(&blobOffset), sizeof(blobOffset));
+    header.append(reinterpret_cast<const char *>(&dumpSize), sizeof(dumpSize));
+    header.append(reinterpret_cast<const char *>(&dumpModified), sizeof(dumpModified));
+
+    QDir().mkpath(QFileInfo(indexFileName).absolutePath());
+    QSaveFile index(indexFileName);
+    if (!index.open(QIODevice::WriteOnly)
+            || index.write(header) != header.size()
+            || index.write(records) != records.size()
+            || index.write(blob) != blob.size()
+            || !index.commit())
+    {
+        if (errorString)
+        {
+            *errorString = index.errorString();
+        }
+        return false;
+    }
+
+    return true;
+}
+
+bool OfflineDictionary::open(const QString &indexFileName)
+{
+    close();
+
+    m_file.setFileName(indexFileName);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    m_size = m_file.size();
+    const uchar *data = m_size >= HEADER_SIZE ? m_file.map(0, m_size) : nullptr;
+    if (!data || std::memcmp(data, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0
+            || getU32(data + 4) != INDEX_VERSION)
+    {
+        m_file.close();
+        return false;
+    }
+
+    m_count = getU32(data + 8);
+    if (HEADER_SIZE + qint64(m_count) * RECORD_SIZE > m_size
+            || qFromLittleEndian<quint64>(data + 16) != quint64(HEADER_SIZE + qint64(m_count) * RECORD_SIZE)
+            || !recordsInRange(data + HEADER_SIZE, m_count, quint64(m_size - HEADER_SIZE - qint64(m_count) * RECORD_SIZE)))
+    {
+        m_count = 0;
+        m_file.close();
+        return false;
+    }
+
+    m_data = data;
+    return true;
+}
+
+bool OfflineDictionary::openDump(const QString &dumpFileName)
+{
+    const QString indexFileName = indexFileNameFor(dumpFileName);
+    const QFileInfo dumpInfo(dumpFileName);
+
+    //an index is only good for the exact dump it was built from
+    if (open(indexFileName)
+            && qFromLittleEndian<quint64>(m_data + 24) == quint64(dumpInfo.size())
+            && qFromLittleEndian<qint64>(m_data + 32) == dumpInfo.lastModified().toMSecsSinceEpoch())
+    {
+        return true;
+    }
+    close();
+
+    QString errorString;
+    if (!import(dumpFileName, indexFileName, &errorString))
+    {
+        qWarning("Cannot import dictionary %s: %s", qPrintable(dumpFileName), qPrintable(errorString));
+        return false;
+    }
+
+    return open(indexFileName);
+}
+
+void OfflineDictionary::close()
+{
+    m_data = nullptr;
+    m_size = 0;
+    m_count = 0;
+    m_file.close();
+}
+
+bool OfflineDictionary::lookup(const QString &language, const QString &word, QByteArray *answer)
+{
+    if (!m_data || language != m_language)
+    {
+        return false;
+    }
+
+    const QByteArray key = word.trimmed().toLower().toUtf8();
+    const uchar *records = m_data + HEADER_SIZE;
+    const uchar *blob = records + qint64(m_count) * RECORD_SIZE;
+
+    quint32 low = 0;
+    quint32 high = m_count;
+    while (low < high)
+    {
+        const quint32 mid = low + (high - low) / 2;
+        const uchar *record = records + qint64(mid) * RECORD_SIZE;
+        const quint32 keyLength = getU32(record + 4);
+
+        int cmp = std::memcmp(blob + getU32(record), key.constData(), qMin<quint32>(keyLength, quint32(key.size())));
+        if (cmp == 0)
+        {
+            cmp = keyLength < quint32(key.size()) ? -1 : (keyLength > quint32(key.size()) ? 1 : 0);
+        }
+
+        if (cmp < 0)
+        {
+            low = mid + 1;
+        }
+        else if (cmp > 0)
+        {
+            high = mid;
+        }
+        else
+        {
+            if (answer)
+            {
+                *answer = QByteArray(reinterpret_cast<const char *>(blob + getU32(record + 8)), int(getU32(record + 12)));
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,39 @@
+#ifndef OFFLINEDICTIONARY_H
+#define OFFLINEDICTIONARY_H
+
+#include "dictionarybackend.h"
+
+#include <QFile>
+
+//Local dictionary served from a memory-mapped binary index.
+//import() converts a tab-separated dump (word, lexical category,
+//definition[, example]) into a sorted key table followed by a blob of
+//prebuilt answers; lookup() binary-searches the mapped keys, so a hit
+//costs a few memcmp()s and one copy of the answer.
+class OfflineDictionary : public DictionaryBackend
+{
+public:
+    OfflineDictionary() = default;
+    ~OfflineDictionary() override;
+
+    static bool import(const QString &dumpFileName, const QString &indexFileName, QString *errorString = nullptr);
+    static QString indexFileNameFor(const QString &dumpFileName);
+
+    bool open(const QString &indexFileName);
+    bool openDump(const QString &dumpFileName);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    int size() const { return int(m_count); }
+
+    QString language() const { return m_language; }
+    bool lookup(const QString &language, const QString &word, QByteArray *answer) override;
+
+private:
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    quint32 m_count = 0;
+    QString m_language = "en-gb";
+};
+
+#endif // OFFLINEDICTIONARY_H
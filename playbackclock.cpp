@@ -0,0 +1,174 @@
+#include "playbackclock.h"
+
+#include <QVideoFrame>
+#include <QVideoProbe>
+#include <QtGlobal>
+
+//anything further off than this is a seek or a stall, not drift
+static const qint64 RESYNC_THRESHOLD = 250;
+//fraction of the measured skew folded into the anchor per sample
+static const qint64 SLEW_DIVISOR = 4;
+//frame timestamps older than this no longer count as authoritative
+static const qint64 FRAME_TIMEOUT = 500;
+
+PlaybackClock::PlaybackClock(QMediaPlayer *player, QObject *parent)
+    : QObject(parent)
+    , m_player(player)
+{
+    m_elapsed.start();
+    m_state = m_player->state();
+    m_rate = m_player->playbackRate() > 0 ? m_player->playbackRate() : 1.0;
+    anchor(m_player->position());
+
+    connect(m_player, &QMediaPlayer::positionChanged, this, &PlaybackClock::positionReported);
+    connect(m_player, &QMediaPlayer::stateChanged, this, &PlaybackClock::stateChanged);
+    connect(m_player, &QMediaPlayer::playbackRateChanged, this, &PlaybackClock::rateChanged);
+}
+
+void PlaybackClock::setVideoProbe(QVideoProbe *probe)
+{
+    connect(probe, &QVideoProbe::videoFrameProbed, this, &PlaybackClock::frameProbed);
+}
+
+qint64 PlaybackClock::position() const
+{
+    qint64 position = extrapolate();
+
+    //small corrections never run the clock backwards while playing;
+    //the anchor catches up instead
+    if (isPlaying())
+    {
+        position = qMax(position, m_lastPosition);
+    }
+    m_lastPosition = position;
+    return position;
+}
+
+qint64 PlaybackClock::extrapolate() const
+{
+    if (!isPlaying())
+    {
+        return m_anchorPosition;
+    }
+
+    const qint64 elapsed = m_elapsed.nsecsElapsed() - m_anchorTime;
+    return m_anchorPosition + qint64(elapsed * m_rate / 1000000.0);
+}
+
+void PlaybackClock::anchor(qint64 position)
+{
+    m_anchorPosition = position;
+    m_anchorTime = m_elapsed.nsecsElapsed();
+    m_lastPosition = position;
+}
+
+void PlaybackClock::positionReported(qint64 position)
+{
+    correct(position, false);
+}
+
+void PlaybackClock::frameProbed(const QVideoFrame &frame)
+{
+    //startTime() is the frame's presentation time in microseconds, or -1
+    //when the backend does not stamp frames
+    if (frame.startTime() < 0)
+    {
+        return;
+    }
+
+    m_lastFrameTime = m_elapsed.elapsed();
+    correct(frame.startTime() / 1000, true);
+}
+
+bool PlaybackClock::framesActive() const
+{
+    return m_lastFrameTime >= 0 && m_elapsed.elapsed() - m_lastFrameTime < FRAME_TIMEOUT;
+}
+
+void PlaybackClock::correct(qint64 observed, bool fromFrame)
+{
+    //two sources a steady offset apart must not take turns re-anchoring
+    //the clock, so only one of them may move it at a time
+    const bool hasPriority = fromFrame || !framesActive();
+
+    if (!isPlaying())
+    {
+        if (!hasPriority)
+        {
+            return;
+        }
+
+        if (observed != m_anchorPosition)
+        {
+            anchor(observed);
+            emit changed();
+        }
+        return;
+    }
+
+    const qint64 predicted = extrapolate();
+    const qint64 skew = observed - predicted;
+
+    if (qAbs(skew) > RESYNC_THRESHOLD)
+    {
+        if (!hasPriority)
+        {
+            return;
+        }
+
+        ++m_stats.resyncs;
+        anchor(observed);
+        emit changed();
+        return;
+    }
+
+    if (fromFrame)
+    {
+        ++m_stats.frameSamples;
+    }
+    else
+    {
+        ++m_stats.positionSamples;
+    }
+    m_skewSum += qAbs(skew);
+    m_stats.lastSkew = skew;
+    m_stats.maxAbsSkew = qMax(m_stats.maxAbsSkew, qAbs(skew));
+    m_stats.meanAbsSkew = m_skewSum / (m_stats.positionSamples + m_stats.frameSamples);
+
+    //backend positions are coarser than frame stamps; while frames keep
+    //arriving they are only measured, not applied
+    if (!hasPriority)
+    {
+        return;
+    }
+
+    const qint64 adjustment = skew / SLEW_DIVISOR;
+    if (adjustment == 0)
+    {
+        return;
+    }
+
+    m_anchorPosition = predicted + adjustment;
+    m_anchorTime = m_elapsed.nsecsElapsed();
+}
+
+void PlaybackClock::stateChanged(QMediaPlayer::State state)
+{
+    //the backend knows exactly where it paused or resumed
+    m_state = state;
+    anchor(m_player->position());
+
+    //frames stop with playback; a seek while paused is the backend's to report
+    if (state != QMediaPlayer::PlayingState)
+    {
+        m_lastFrameTime = -1;
+    }
+    emit changed();
+}
+
+void PlaybackClock::rateChanged(qreal rate)
+{
+    anchor(extrapolate());
+    m_rate = rate > 0 ? rate : 1.0;
+    emit changed();
+}
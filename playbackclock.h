@@ -0,0 +1,75 @@
+#ifndef PLAYBACKCLOCK_H
+#define PLAYBACKCLOCK_H
+
+#include <QElapsedTimer>
+#include <QMediaPlayer>
+#include <QObject>
+
+QT_BEGIN_NAMESPACE
+class QVideoFrame;
+class QVideoProbe;
+QT_END_NAMESPACE
+
+//Millisecond playback position between the backend's coarse
+//positionChanged updates. Extrapolates from the last anchor with a
+//monotonic timer and the playback rate, and slews towards the reported
+//position (or probed frame timestamps) instead of jumping on every update.
+class PlaybackClock : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats
+    {
+        int positionSamples = 0;
+        int frameSamples = 0;
+        int resyncs = 0;
+        double meanAbsSkew = 0;
+        qint64 maxAbsSkew = 0;
+        qint64 lastSkew = 0;
+    };
+
+    explicit PlaybackClock(QMediaPlayer *player, QObject *parent = nullptr);
+
+    //frames carry their own presentation time; while a probe delivers
+    //timestamps they are the only source that corrects or resyncs the
+    //clock, and backend positions are only measured
+    void setVideoProbe(QVideoProbe *probe);
+
+    qint64 position() const;
+    bool isPlaying() const { return m_state == QMediaPlayer::PlayingState; }
+    qreal rate() const { return m_rate; }
+
+    Stats stats() const { return m_stats; }
+
+signals:
+    //the timeline moved other than by elapsing: seek or resync, state or
+    //rate change; anything sleeping until a position should re-arm.
+    //Small slews stay silent, they never move the clock by much
+    void changed();
+
+private slots:
+    void positionReported(qint64 position);
+    void frameProbed(const QVideoFrame &frame);
+    void stateChanged(QMediaPlayer::State state);
+    void rateChanged(qreal rate);
+
+private:
+    qint64 extrapolate() const;
+    void correct(qint64 observed, bool fromFrame);
+    bool framesActive() const;
+    void anchor(qint64 position);
+
+    QMediaPlayer *m_player = nullptr;
+    QElapsedTimer m_elapsed;
+    qint64 m_anchorPosition = 0;
+    qint64 m_anchorTime = 0;
+    qint64 m_lastFrameTime = -1;
+    mutable qint64 m_lastPosition = 0;
+    qreal m_rate = 1.0;
+    QMediaPlayer::State m_state = QMediaPlayer::StoppedState;
+    Stats m_stats;
+    double m_skewSum = 0;
+};
+
+#endif // PLAYBACKCLOCK_H
@@ -50,9 +50,23 @@
 
 #include "player.h"
 
+#include "definitionparser.h"
+#include "definitionprefetcher.h"
+#include "dictionarycache.h"
+#include "dictionaryclient.h"
+#include "lemmatizer.h"
+#include "logging.h"
+#include "mediascanner.h"
+#include "offlinedictionary.h"
+#include "playbackclock.h"
 #include "playercontrols.h"
 #include "playlistmodel.h"
+#include "startupprofiler.h"
+#include "subtitleloader.h"
+#include "subtitlescheduler.h"
+#include "subtitlewords.h"
 #include "videowidget.h"
+#include "wordindex.h"
 
 #include <QMediaService>
 #include <QMediaPlaylist>
@@ -65,27 +79,28 @@
 #include <QNetworkReply>
 #include <QCloseEvent>
 
-#define DEFAULT_SUB_FONTSIZE 22
 #define DEFAULT_TS_FONTSIZE 14
 
+//scanner results are published together, one snapshot per burst
+static const int SCAN_PUBLISH_DELAY = 100;
+
 Player::Player(QWidget *parent)
     : QWidget(parent)
 {
 //! [create-objs]
     m_player = new QMediaPlayer(this);
     m_player->setAudioRole(QAudio::VideoRole);
-    qInfo() << "Supported audio roles:";
-    for (QAudio::Role role : m_player->supportedAudioRoles())
-        qInfo() << "    " << role;
     // owned by PlaylistModel
     m_playlist = new QMediaPlaylist();
     m_player->setPlaylist(m_playlist);
 //! [create-objs]
+    StartupProfiler::mark("media player");
 
     connect(m_player, &QMediaPlayer::durationChanged, this, &Player::durationChanged);
     connect(m_player, &QMediaPlayer::positionChanged, this, &Player::positionChanged);
     connect(m_player, QOverload<>::of(&QMediaPlayer::metaDataChanged), this, &Player::metaDataChanged);
     connect(m_playlist, &QMediaPlaylist::currentIndexChanged, this, &Player::playlistPositionChanged);
+    connect(m_playlist, &QMediaPlaylist::mediaInserted, this, &Player::playlistMediaInserted);
     connect(m_player, &QMediaPlayer::mediaStatusChanged, this, &Player::statusChanged);
     connect(m_player, &QMediaPlayer::bufferStatusChanged, this, &Player::bufferingProgress);
     //connect(m_player, &QMediaPlayer::videoAvailableChanged, this, &Player::videoAvailableChanged);
@@ -97,9 +112,13 @@ Player::Player(QWidget *parent)
     m_playlistModel = new PlaylistModel(this);
     m_playlistModel->setPlaylist(m_playlist);
 //! [2]
+    StartupProfiler::mark("video output");
 
-    m_playlistView = new QListView(this);
-    m_playlistView->setModel(m_playlistModel);
+    QListView *playlistView = new QListView(this);
+    playlistView->setModel(m_playlistModel);
+    //rows are one line of text, so the view can skip measuring each of them
+    playlistView->setUniformItemSizes(true);
+    m_playlistView = playlistView;
 
     //set current index
     currentIndex = m_playlist->currentIndex();
@@ -117,8 +136,12 @@ Player::Player(QWidget *parent)
     QPushButton *openVideoButton = new QPushButton(tr("Open Video"), this);
     connect(openVideoButton, &QPushButton::clicked, this, &Player::open);
 
+    //open folder button
+    QPushButton *openFolderButton = new QPushButton(tr("Open Folder"), this);
+    connect(openFolderButton, &QPushButton::clicked, this, &Player::openFolder);
+
     //add subtitle button
-    QPushButton *addSRTButton = new QPushButton(tr("Add SRT file"), this);
+    QPushButton *addSRTButton = new QPushButton(tr("Add subtitle file"), this);
     connect(addSRTButton, &QPushButton::clicked, this, &Player::addSRT);
 
     PlayerControls *controls = new PlayerControls(this);
@@ -144,35 +167,62 @@ Player::Player(QWidget *parent)
     m_transcript = new QTextEdit(this);
     m_transcript->setReadOnly(true);
     m_transcript->setFontPointSize(DEFAULT_TS_FONTSIZE);
+    emptyTranscript = new QTextDocument(this);
     connect(m_transcript, &QTextEdit::copyAvailable, this, &Player::wordHighlighted);
 
-    m_subtitles = new QTextEdit(parent);
-    m_subtitles->setReadOnly(true);
-    m_subtitles->setFontPointSize(DEFAULT_SUB_FONTSIZE);
-    connect(this, &Player::drawSubtitles_signal, this, &Player::drawSubtitles);
-    connect(m_subtitles, &QTextEdit::copyAvailable, this, &Player::wordHighlighted);
-
-    QSplitter* splitter1 = new QSplitter(Qt::Vertical, parent);
+    //subtitles are painted over the video; clicking a word looks it up
+    //cue timing follows an interpolated clock, corrected by frame
+    //timestamps where the backend lets us probe the video
+    m_clock = new PlaybackClock(m_player, this);
+    m_videoProbe = new QVideoProbe(this);
+    if (m_videoProbe->setSource(m_player))
+    {
+        m_clock->setVideoProbe(m_videoProbe);
+        StartupProfiler::watchFirstFrame(m_player, m_videoProbe);
+    }
+    else
+    {
+        StartupProfiler::watchFirstFrame(m_player, nullptr);
+    }
+    m_subtitleScheduler = new SubtitleScheduler(m_clock, this);
+    connect(m_subtitleScheduler, &SubtitleScheduler::cueChanged, m_videoWidget, &VideoWidget::showCue);
+    connect(m_subtitleScheduler, &SubtitleScheduler::cueChanged, this, &Player::setTranscriptPosition);
+    connect(m_videoWidget, &VideoWidget::wordClicked, this, &Player::lookupWord);
 
     QVBoxLayout* transcriptVlayout = new QVBoxLayout();
-    splitter1->addWidget(m_videoWidget);
-    transcriptVlayout->addWidget(splitter1);
-    splitter1->addWidget(m_subtitles);
-    splitter1->setStretchFactor(0, 1);
-    splitter1->setStretchFactor(1, 0);
+    transcriptVlayout->addWidget(m_videoWidget);
     m_videoWidget->setMinimumHeight(500);
-    int videoWidget_index = splitter1->indexOf(m_videoWidget);
-    splitter1->setCollapsible(videoWidget_index, false);
-    splitter1->setChildrenCollapsible(false);
+
+    StartupProfiler::mark("controls");
+
+    //subtitles of opened media are found and parsed in the background
+    m_scanner = new MediaScanner(this);
+    connect(m_scanner, &MediaScanner::mediaFound, this, &Player::libraryMediaFound);
+    connect(m_scanner, &MediaScanner::mediaScanned, this, &Player::subtitlesScanned);
+    connect(m_scanner, &MediaScanner::scanFinished, this, &Player::scanFinished);
+
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setPlaceholderText(tr("Find a word in all subtitles"));
+    m_searchEdit->setClearButtonEnabled(true);
+    connect(m_searchEdit, &QLineEdit::returnPressed, this, &Player::searchWord);
+
+    m_searchResults = new QListWidget(this);
+    connect(m_searchResults, &QListWidget::itemActivated, this, &Player::searchResultActivated);
+
+    QVBoxLayout* searchVlayout = new QVBoxLayout();
+    searchVlayout->addWidget(m_transcript, 3);
+    searchVlayout->addWidget(m_searchEdit);
+    searchVlayout->addWidget(m_searchResults, 1);
 
     QHBoxLayout* transcriptHlayout = new QHBoxLayout();
     transcriptHlayout->addWidget(m_playlistView, 2);
     transcriptHlayout->addLayout(transcriptVlayout, 10);
-    transcriptHlayout->addWidget(m_transcript, 3);
+    transcriptHlayout->addLayout(searchVlayout, 3);
 
     QBoxLayout *controlLayout = new QHBoxLayout;
     controlLayout->setMargin(0);
     controlLayout->addWidget(openVideoButton);
+    controlLayout->addWidget(openFolderButton);
     controlLayout->addWidget(addSRTButton);
     controlLayout->addStretch(1);
     controlLayout->addWidget(controls);
@@ -196,33 +246,15 @@ Player::Player(QWidget *parent)
         controls->setEnabled(false);
         m_playlistView->setEnabled(false);
         openVideoButton->setEnabled(false);
+        openFolderButton->setEnabled(false);
         addSRTButton->setEnabled(false);
     }
 
     metaDataChanged();
+    StartupProfiler::mark("layout");
 
-    //functions using threads
-    processSubtitles();
-    highlight_currentLine();
-
-    //connect network manager signal/slots
-    manager = new QNetworkAccessManager();
-    connect(manager, &QNetworkAccessManager::finished, this, &Player::managerFinished);
-
-    //dictionary dialog
-    definition_dialog = new QDialog(this);
-    definition_dialog->setWindowFlags(Qt::Popup);
-
-    dictionaryOutput = new QTextEdit();
-
-    scroll = new QScrollArea(definition_dialog);
-    scroll->setWidgetResizable(true);
-    scroll->setWidget(dictionaryOutput);
-
-    // Add a layout for QDialog
-    dialog_layout = new QHBoxLayout(definition_dialog);
-    definition_dialog->setLayout(dialog_layout);
-    definition_dialog->layout()->addWidget(scroll);
+    //the word index, dictionary cache, network stack and popup are
+    //created on first use; none of them is needed to start playing
 
     //TEST
     m_transcript->setText("TEST WORD LIST HERE");
@@ -233,17 +265,102 @@ Player::Player(QWidget *parent)
 
 Player::~Player()
 {
-    if (subtitle_thread.joinable())
+    if (m_dictionaryClient)
+    {
+        const DictionaryClient::Stats requests = m_dictionaryClient->stats();
+        qCInfo(lcStats) << "Dictionary requests:" << requests.requests << "sent for" << requests.fetches << "fetches,"
+                << requests.merged << "merged," << requests.retries << "retries," << requests.timeouts << "timeouts,"
+                << requests.throttled << "throttled," << requests.failures << "failed; latency p50"
+                << requests.p50 << "ms, p90" << requests.p90 << "ms, p99" << requests.p99 << "ms";
+        //answers still in flight would land in the cache deleted below
+        delete m_dictionaryClient;
+        m_dictionaryClient = nullptr;
+    }
+
+    const PlaybackClock::Stats skew = m_clock->stats();
+    qCInfo(lcStats) << "Playback clock:" << skew.positionSamples << "position and" << skew.frameSamples
+            << "frame samples, mean skew" << skew.meanAbsSkew << "ms, max" << skew.maxAbsSkew
+            << "ms," << skew.resyncs << "resyncs";
+
+    if (m_dictionaryCache)
+    {
+        const DictionaryCache::Stats stats = m_dictionaryCache->stats();
+        qCInfo(lcStats) << "Dictionary cache:" << stats.hits << "hits," << stats.misses << "misses,"
+                << stats.entries << "entries," << stats.bytes << "bytes";
+    }
+    delete m_dictionaryCache;
+    delete m_offlineDictionary;
+}
+
+WordIndex *Player::wordIndex()
+{
+    //library-wide word search under the transcript
+    if (!m_wordIndex)
     {
-        subtitle_thread.join();
+        m_wordIndex = new WordIndex(WordIndex::defaultFileName(), this);
     }
+    return m_wordIndex;
+}
+
+DictionaryCache *Player::dictionaryCache()
+{
+    //lookups are served from here before going to the network
+    if (!m_dictionaryCache)
+    {
+        m_dictionaryCache = new DictionaryCache(DictionaryCache::defaultFileName());
+    }
+    return m_dictionaryCache;
+}
 
-    if (highlightline_thread.joinable())
+DictionaryClient *Player::dictionaryClient()
+{
+    //lookups and prefetches share one rate limit and one request per word;
+    //the client brings up its network manager on the first request
+    if (!m_dictionaryClient)
+    {
+        m_dictionaryClient = new DictionaryClient(nullptr, this);
+        m_dictionaryClient->setCache(dictionaryCache());
+        connect(m_dictionaryClient, &DictionaryClient::finished, this, &Player::definitionFetched);
+    }
+    return m_dictionaryClient;
+}
+
+DefinitionPrefetcher *Player::prefetcher()
+{
+    //warm the cache with words from the upcoming subtitles
+    if (!m_prefetcher)
     {
-        highlightline_thread.join();
+        m_prefetcher = new DefinitionPrefetcher(m_player, dictionaryCache(), dictionaryClient(), language_code, this);
+        m_prefetcher->setBackend(m_offlineDictionary);
     }
+    return m_prefetcher;
+}
 
-    delete manager;
+void Player::createDefinitionDialog()
+{
+    //dictionary dialog
+    //non-modal, so playback controls and new selections stay responsive
+    definition_dialog = new QDialog(this);
+    definition_dialog->setWindowFlags(Qt::Tool);
+    connect(definition_dialog, &QDialog::finished, this, [this]()
+    {
+        if (pausedForLookup && m_player->state() == QMediaPlayer::PausedState)
+        {
+            m_player->play();
+        }
+        pausedForLookup = false;
+    });
+
+    dictionaryOutput = new QTextEdit();
+
+    scroll = new QScrollArea(definition_dialog);
+    scroll->setWidgetResizable(true);
+    scroll->setWidget(dictionaryOutput);
+
+    // Add a layout for QDialog
+    dialog_layout = new QHBoxLayout(definition_dialog);
+    definition_dialog->setLayout(dialog_layout);
+    definition_dialog->layout()->addWidget(scroll);
 }
 
 void Player::closeEvent (QCloseEvent *event)
@@ -258,18 +375,6 @@ void Player::closeEvent (QCloseEvent *event)
     }
     else
     {
-        threadRun = false;
-
-        if (subtitle_thread.joinable())
-        {
-            subtitle_thread.join();
-        }
-
-        if (highlightline_thread.joinable())
-        {
-            highlightline_thread.join();
-        }
-
         event->accept();
     }
 }
@@ -285,200 +390,151 @@ void Player::wordHighlighted(bool yes)
     QObject* sender = this->sender();
     QTextEdit* origin_txtedit = qobject_cast<QTextEdit*>(sender);
 
-    origin_txtedit->copy();
-    curSelectedWord = QApplication::clipboard()->text();
-    QRegularExpression re("[^\\d\\W]");
-    QRegularExpressionMatch match = re.match(curSelectedWord);
+    //the first word of the selection, without surrounding punctuation or markup
+    const QString selection = origin_txtedit->textCursor().selectedText();
+    QVector<SubtitleWords::Span> spans;
+    SubtitleWords::tokenize(selection.constData(), selection.size(), &spans);
 
-    if (!match.hasMatch())
+    if (spans.isEmpty())
     {
         curSelectedWord.clear();
         return;
     }
+    curSelectedWord = selection.mid(spans.first().offset, spans.first().length);
 
-    if (m_player->state() == QMediaPlayer::PlayingState)
+    lookupWord(curSelectedWord);
+}
+
+void Player::lookupWord(const QString &word)
+{
+    if (word.isEmpty())
     {
-        m_player->pause();
+        return;
     }
 
-    if (!curSelectedWord.isEmpty())
+    if (m_player->state() == QMediaPlayer::PlayingState)
     {
-        APIRequest();
+        m_player->pause();
+        pausedForLookup = true;
     }
+
+    APIRequest(word);
 }
 
-void Player::APIRequest()
+void Player::APIRequest(const QString &selection)
 {
-    QString endpoint = "entries";
-    QString language_code = "en-gb";
-
-    auto url = QUrl("https://od-api.oxforddictionaries.com/api/v2/" + endpoint + "/" + language_code + "/" + curSelectedWord);
+    //each lookup carries its own id; replies for older ids are dropped
+    const quint64 id = ++lookupId;
 
-    request.setUrl(url);
-    request.setRawHeader("app_id", app_id);
-    request.setRawHeader("app_key", app_key);
-    manager->get(request);
-}
+    //"Runs", "running" and "ran" share one cache entry and one request;
+    //a guessed lemma falls back to the word as written
+    const QStringList keys = Lemmatizer::keys(SubtitleWords::fold(QStringRef(&selection)));
 
-void Player::managerFinished(QNetworkReply *reply)
-{
-    if (reply->error()) {
-        QMessageBox msgBox;
-        msgBox.setWindowFlags(Qt::Popup);
-        msgBox.setText("Dictionary entry for '" + curSelectedWord + "' is not available");
-        msgBox.exec();
+    //cleared first: cancelling a word that has not been sent reports it
+    //finished on the spot, and that is no answer to this lookup
+    if (!pendingWord.isEmpty())
+    {
+        const QString cancelled = pendingWord;
+        pendingWord.clear();
+        dictionaryClient()->cancel(language_code, cancelled);
+    }
+    pendingFallbacks.clear();
 
-        if (m_player->state() == QMediaPlayer::PausedState)
+    QByteArray cached;
+    for (const QString &key : keys)
+    {
+        if (dictionaryCache()->lookup(language_code, key, &cached))
         {
-            m_player->play();
+            showDefinition(id, cached);
+            return;
         }
 
-        return;
+        //local dictionary answers without touching the network
+        if (m_offlineDictionary && m_offlineDictionary->lookup(language_code, key, &cached))
+        {
+            showDefinition(id, cached);
+            return;
+        }
     }
 
-    //populate dialog
-    dict_answer = reply->readAll();
-    outputString = parse_JSON_Response(dict_answer);
-    dictionaryOutput->setText(outputString);
-    definition_dialog->setMinimumSize(QSize(m_transcript->height()/2, m_transcript->height()));
-    definition_dialog->exec();
+    showDefinitionText("<p>Looking up <b>" + keys.first().toHtmlEscaped() + "</b>...</p>");
 
-    if (m_player->state() == QMediaPlayer::PausedState)
-    {
-        m_player->play();
-    }
+    pendingWord = keys.first();
+    pendingFallbacks = keys.mid(1);
+    dictionaryClient()->fetch(language_code, pendingWord);
 }
 
-QString Player::parse_JSON_Response(QByteArray answer)
+void Player::definitionFetched(const QString &language, const QString &word,
+                               QNetworkReply::NetworkError error, const QByteArray &answer)
 {
-    QStringList outputList;
-
-    QJsonDocument jsonResponse = QJsonDocument::fromJson(answer);
-
-    QJsonObject jsonObject = jsonResponse.object();
-
-    QJsonArray results_array = jsonObject["results"].toArray();
-    QJsonObject results_obj = results_array.at(0).toObject();
-
-    //word
-    QString word = results_obj["id"].toString();
-    outputList.push_back("<p style='color:red'>");
-    outputList.push_back("<b>");
-    outputList.push_back(word);
-    outputList.push_back("</b>");
-    outputList.push_back("</p>");
-    outputList.push_back("<br>");
-
-    QJsonArray lexicalEntries_array = results_obj["lexicalEntries"].toArray();
+    //answers for superseded lookups and prefetches are already cached
+    if (language != language_code || word != pendingWord)
+    {
+        return;
+    }
+    pendingWord.clear();
 
-    for (auto lexicalEntry : lexicalEntries_array)
+    //no entry under the guessed lemma: try the next key
+    if (error == QNetworkReply::ContentNotFoundError && !pendingFallbacks.isEmpty())
     {
-        QJsonObject lexEntry_obj = lexicalEntry.toObject();
+        pendingWord = pendingFallbacks.takeFirst();
+        dictionaryClient()->fetch(language_code, pendingWord);
+        return;
+    }
 
-        auto lexCat_obj = lexEntry_obj["lexicalCategory"].toObject();
-        //lexical category
-        outputList.push_back("<i>" + lexCat_obj["text"].toString() + "</i>" + "</li>" + "<br>");
-        outputList.push_back("<br>");
+    if (error != QNetworkReply::NoError) {
+        showDefinitionText("Dictionary entry for '" + word.toHtmlEscaped() + "' is not available");
+        return;
+    }
 
-        QJsonArray entries_array = lexEntry_obj["entries"].toArray();
-        QJsonObject entry_obj = entries_array.at(0).toObject();
+    showDefinition(lookupId, answer);
+}
 
-        QJsonArray pronunc_array = entry_obj["pronunciations"].toArray();
+void Player::showDefinition(quint64 id, const QByteArray &answer)
+{
+    //parse and build the HTML off the GUI thread
+    auto watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, id]()
+    {
+        watcher->deleteLater();
 
-        for (auto pronunc : pronunc_array)
+        if (id == lookupId)
         {
-            QJsonObject pronunc_obj = pronunc.toObject();
-            //pronunciation
-            outputList.push_back("<a href='" + pronunc_obj["audioFile"].toString() + "'>Pronunciation</a>");
-            outputList.push_back("<br>");
-            outputList.push_back("<br>");
+            showDefinitionText(watcher->result());
         }
+    });
+    watcher->setFuture(QtConcurrent::run(&Player::parse_JSON_Response, answer));
+}
 
-        QJsonArray senses_array = entry_obj["senses"].toArray();
-
-        for (int i = 0; i < 2; ++i)
-        {
-            QJsonObject sense_obj = senses_array.at(i).toObject();
-            QJsonArray definition_array = sense_obj["definitions"].toArray();
-            //definition
-            outputList.push_back("<b>");
-            outputList.push_back(definition_array.at(0).toString());
-            outputList.push_back("</b>");
-            outputList.push_back("<br>");
-
-            QJsonArray xReference_array = sense_obj["crossReferenceMarkers"].toArray();
-            //cross-references
-            for (auto xReference : xReference_array)
-            {
-                outputList.push_back("<b>");
-                outputList.push_back(xReference.toString());
-                outputList.push_back("</b>");
-                outputList.push_back("<br>");
-            }
-
-            QJsonArray examples_array = sense_obj["examples"].toArray();
-
-            if (!examples_array.empty())
-            {
-                for (auto example : examples_array)
-                {
-                    QJsonObject example_obj = example.toObject();
-                    //example
-                    outputList.push_back("<ul>");
-                    outputList.push_back("<li>");
-                    outputList.push_back("Example: " + example_obj["text"].toString());
-                    outputList.push_back("</ul>");
-                }
-            }
-
-            QJsonArray synonym_array = sense_obj["synonyms"].toArray();
-
-            QString synonymStr;
-
-            if (!synonym_array.empty())
-            {
-                for (auto synonym : synonym_array)
-                {
-                    QJsonObject synonym_obj = synonym.toObject();
-                    synonymStr += QString(", " + synonym_obj["text"].toString());
-                }
-                //synonym
-                outputList.push_back("<ul>");
-                outputList.push_back("<li>");
-                outputList.push_back("Synonyms: " + synonymStr);
-                outputList.push_back("</ul>");
-
-            }
-        }
-        outputList.push_back("<hr>");
-        outputList.push_back("<br>");   //line break
+void Player::showDefinitionText(const QString &html)
+{
+    if (!definition_dialog)
+    {
+        createDefinitionDialog();
     }
 
-    outputList.push_back("<p align='right'>");
-    QString more_url = "https://www.google.com/search?dictcorpus=en-gb&hl=en&forcedict=" +
-            word + "&q=define%20" + word;
-    outputList.push_back("<a href='" + more_url + "'>" + "View More (Google Search)</a>");
-    outputList.push_back("</p>");
+    //populate dialog
+    dictionaryOutput->setText(html);
+    definition_dialog->setMinimumSize(QSize(m_transcript->height()/2, m_transcript->height()));
 
-    QString outputString;
-    for (auto line : outputList)
+    if (!definition_dialog->isVisible())
     {
-        outputString += line;
+        definition_dialog->show();
     }
-
-    return outputString;
+    definition_dialog->raise();
 }
 
-void Player::highlight_currentLine()
+QString Player::parse_JSON_Response(const QByteArray &answer)
 {
-    highlightline_thread = std::thread([&]()
+    //one entry per pool thread, so its arena is reused across lookups
+    static thread_local DictionaryEntry entry;
+
+    if (!DefinitionParser::parse(answer, &entry))
     {
-        while (threadRun)
-        {
-            setTranscriptPosition();
-            std::this_thread::sleep_for(std::chrono::milliseconds(300));
-        }
-    });
+        return "Dictionary entry could not be read";
+    }
+
+    return DefinitionParser::renderHtml(entry);
 }
 
 void Player::showContextMenu(const QPoint &pos)
@@ -494,9 +550,8 @@ void Player::showContextMenu(const QPoint &pos)
         isDefMenu_constructed = true;
     }
 
-    QTextCursor tc = m_transcript->cursorForPosition(pos);
-    tc.select(QTextCursor::WordUnderCursor);
-    current_word = tc.selectedText();
+    const QTextCursor tc = m_transcript->cursorForPosition(pos);
+    current_word = SubtitleWords::wordAt(tc.block().text(), tc.positionInBlock());
 
     if(!current_word.isEmpty())
     {
@@ -507,188 +562,381 @@ void Player::showContextMenu(const QPoint &pos)
 
 void Player::getWord()
 {
-    emit drawSubtitles_signal(current_word);
+    lookupWord(current_word);
     current_word.clear();
 }
 
-void Player::setTranscriptPosition()
+void Player::setTranscriptPosition(int cue)
 {
-    if (currentIndex < 0)
+    //keep the last cue highlighted in the gaps between cues
+    if (cue < 0 || currentIndex < 0 || currentIndex >= transcript_List.size()
+            || cue >= transcript_List.at(currentIndex).blocks.size())
     {
         return;
     }
 
-    auto cur_subtitles = subtitle_List.at(m_playlistModel->index(currentIndex, 0).row());
-    for (int i = 0; i < cur_subtitles.size(); ++i)
+    const CueTable cues = m_subtitleStore.snapshot()->track(currentIndex);
+    const QTextBlock timingBlock = transcript_List.at(currentIndex).blocks.at(cue);
+
+    //timing line plus the cue's text lines
+    QTextEdit::ExtraSelection selection;
+    selection.format.setBackground(m_transcript->palette().color(QPalette::AlternateBase).darker(110));
+    selection.cursor = QTextCursor(timingBlock);
+    selection.cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor, cues.at(cue).lineCount);
+    selection.cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+    m_transcript->setExtraSelections({selection});
+
+    moveScrollBar(timingBlock);
+}
+
+void Player::moveScrollBar(const QTextBlock &block)
+{
+    QScrollBar *vbar = m_transcript->verticalScrollBar();
+    vbar->setValue(int(m_transcript->document()->documentLayout()->blockBoundingRect(block).top()));
+}
+
+QString Player::format_time(int time)
+{
+    if (time < 10)
     {
-        if (cur_subtitles.at(i).contains("-->"))
+        return "0" + QString::number(time);
+    }
+    else
+    {
+        return QString::number(time);
+    }
+}
+
+void Player::loadTranscript()
+{
+    m_transcript->setExtraSelections({});
+
+    const SubtitleStore::Snapshot subtitles = m_subtitleStore.snapshot();
+    if (currentIndex < 0 || currentIndex >= subtitles->size())
+    {
+        m_transcript->setDocument(emptyTranscript);
+        return;
+    }
+
+    if (transcript_List.size() < subtitles->size())
+    {
+        transcript_List.resize(subtitles->size());
+    }
+
+    //built on first view, so switching back to a track is just a document swap
+    Transcript &transcript = transcript_List[currentIndex];
+    if (!transcript.document)
+    {
+        buildTranscript(subtitles->tracks.at(currentIndex), &transcript);
+    }
+
+    m_transcript->setDocument(transcript.document);
+}
+
+void Player::buildTranscript(const CueTable &cues, Transcript *transcript)
+{
+    //one plain-text batch instead of an append (and relayout) per line
+    QString text;
+    text.reserve(cues.size() * 48);
+
+    QVector<int> timingLines;
+    timingLines.reserve(cues.size());
+    int line = 0;
+
+    for (int i = 0; i < cues.size(); ++i)
+    {
+        text += QString::number(i + 1);
+        text += '\n';
+        timingLines.push_back(++line);
+        text += CueTable::formatTiming(cues.at(i));
+        text += '\n';
+        text += cues.textRef(i);
+        text += "\n\n";
+        line += qMax(1, cues.at(i).lineCount) + 2;
+    }
+
+    QTextDocument *document = new QTextDocument(this);
+    QFont font = document->defaultFont();
+    font.setPointSize(DEFAULT_TS_FONTSIZE);
+    document->setDefaultFont(font);
+    document->setUndoRedoEnabled(false);
+    document->setPlainText(text);
+
+    //single forward walk to resolve the block of every timing line
+    transcript->blocks.clear();
+    transcript->blocks.reserve(timingLines.size());
+    QTextBlock block = document->begin();
+    int blockNumber = 0;
+    for (int timingLine : timingLines)
+    {
+        while (block.isValid() && blockNumber < timingLine)
         {
-            if (isWithinSubPeriod(m_player->position(), cur_subtitles.at(i)))
-            {
-                QString searchString = cur_subtitles.at(i);
-                m_transcript->find(searchString);
-                moveScrollBar();
-            }
+            block = block.next();
+            ++blockNumber;
         }
+        transcript->blocks.push_back(block);
     }
+
+    transcript->document = document;
 }
 
-void Player::moveScrollBar()
+void Player::discardTranscript(int index)
 {
-    QScrollBar *vbar = m_transcript->verticalScrollBar();
-    vbar->setValue(vbar->value() + m_transcript->cursorRect().top());
+    if (index < 0 || index >= transcript_List.size())
+    {
+        return;
+    }
+
+    if (m_transcript->document() == transcript_List.at(index).document)
+    {
+        m_transcript->setDocument(emptyTranscript);
+    }
+
+    delete transcript_List.at(index).document;
+    transcript_List[index] = Transcript();
 }
 
-void Player::processSubtitles()
+void Player::loadSubtitles()
 {
-    subtitle_thread = std::thread([&]()
+    //transcript first, so the scheduler's initial cue can be highlighted
+    loadTranscript();
+
+    const CueTable cues = m_subtitleStore.snapshot()->track(currentIndex);
+    m_videoWidget->setCueTable(cues);
+    m_subtitleScheduler->setCueTable(cues);
+    //no need to bring up the cache for a video without subtitles
+    if (m_prefetcher || !cues.isEmpty())
     {
-        while (threadRun)
-        {
-            if (currentIndex < 0 || m_player->state() != QMediaPlayer::PlayingState)
-            {
-                continue;
-            }
+        prefetcher()->setCueTable(cues);
+    }
+}
 
-            auto cur_subtitles = subtitle_List.at(m_playlistModel->index(currentIndex, 0).row());
-            for (int i = 0; i < cur_subtitles.size(); ++i)
-            {
-                if (cur_subtitles.at(i).contains("-->"))
-                {
-                    if (isWithinSubPeriod(m_player->position(), cur_subtitles.at(i)))
-                    {
-                        QString fullSub = cur_subtitles.at(i+1) + " " + cur_subtitles.at(i+2);
-                        emit drawSubtitles_signal(fullSub);
-                    }
-                }
-            }
-        }
-    });
+bool Player::isPlayerAvailable() const
+{
+    return m_player->isAvailable();
 }
 
-qint64 Player::SRTStartTime_to_milliseconds(QString subtitle_time)
+void Player::open()
 {
-    auto startHour = subtitle_time.mid(0, 2).toInt();
-    auto startMinutes = subtitle_time.mid(3, 2).toInt();
-    auto startSeconds = subtitle_time.mid(6, 2).toInt();
-    auto startRemainder = subtitle_time.mid(9, 3).toInt();
+    QFileDialog fileDialog(this);
+    fileDialog.setAcceptMode(QFileDialog::AcceptOpen);
+    fileDialog.setWindowTitle(tr("Open Files"));
+    fileDialog.setNameFilter(tr("Videos (*.mkv *.mp4 *.avi)"));
 
-    return (startHour * 3600000) + (startMinutes * 60000) + (startSeconds * 1000) + (startRemainder);
+    fileDialog.setDirectory(QStandardPaths::standardLocations(QStandardPaths::MoviesLocation).value(0, QDir::homePath()));
+    if (fileDialog.exec() == QDialog::Accepted)
+    {
+        QStringList files;
+        for (const QUrl &url : fileDialog.selectedUrls())
+        {
+            files.push_back(url.toLocalFile());
+        }
+        openMedia(files);
+    }
 }
 
-qint64 Player::SRTEndTime_to_milliseconds(QString subtitle_time)
+void Player::openFolder()
 {
-    auto endHour = subtitle_time.mid(17, 2).toInt();
-    auto endMinutes = subtitle_time.mid(20, 2).toInt();
-    auto endSeconds = subtitle_time.mid(23, 2).toInt();
-    auto endRemainder = subtitle_time.mid(26, 3).toInt();
+    const QString directory = QFileDialog::getExistingDirectory(this, tr("Open Folder"),
+            QStandardPaths::standardLocations(QStandardPaths::MoviesLocation).value(0, QDir::homePath()));
+    if (!directory.isEmpty())
+    {
+        scanLibrary({directory});
+    }
+}
 
-    return (endHour * 3600000) + (endMinutes * 60000) + (endSeconds * 1000) + (endRemainder);
+void Player::openMedia(const QStringList &files)
+{
+    appendMedia(files);
 }
 
-bool Player::isWithinSubPeriod(qint64 curPos, QString subtitle_time)
+void Player::scanLibrary(const QStringList &directories)
 {
-    return SRTStartTime_to_milliseconds(subtitle_time) <= curPos && SRTEndTime_to_milliseconds(subtitle_time) >= curPos;
+    //media found there arrives through libraryMediaFound()
+    m_scanner->scanDirectories(directories);
 }
 
-QString Player::format_time(int time)
+void Player::appendMedia(const QStringList &files)
 {
-    if (time < 10)
+    //subtitle rows are reserved by playlistMediaInserted(), as an .m3u
+    //can expand into any number of entries, and only once it has loaded
+    QList<QUrl> urls;
+    for (const QString &file : files)
     {
-        return "0" + QString::number(time);
+        urls.push_back(QUrl::fromLocalFile(file));
     }
-    else
+
+    addToPlaylist(urls);
+}
+
+void Player::playlistMediaInserted(int start, int end)
+{
+    //media is normally appended; rows inserted before the end push the
+    //ones after them down, with their transcripts and pending scans
+    const int count = end - start + 1;
+    if (start < m_subtitleStore.snapshot()->size())
     {
-        return QString::number(time);
+        shiftRows(start, count);
+    }
+    m_subtitleStore.insertRows(start, count);
+
+    //rows appear at once; their subtitles are filled in as the scanner parses them
+    for (int row = start; row <= end; ++row)
+    {
+        const QString file = mediaFileAt(row);
+        if (file.isEmpty())
+        {
+            continue;
+        }
+
+        if (!pendingSubtitles.contains(file))
+        {
+            unscannedMedia.push_back(file);
+        }
+        pendingSubtitles.insert(file, row);
     }
+
+    //a loading playlist inserts its entries one by one; scan them together
+    if (!unscannedMedia.isEmpty() && !scanQueued)
+    {
+        scanQueued = true;
+        QTimer::singleShot(0, this, &Player::scanInsertedMedia);
+    }
+
+    loadSubtitles();
 }
 
-void Player::loadTranscript()
+void Player::shiftRows(int start, int count)
 {
-    m_transcript->clear();
-    if (currentIndex >= 0)
+    if (start < transcript_List.size())
     {
-        for (auto line : subtitle_List.at(currentIndex))
+        transcript_List.insert(start, count, Transcript());
+    }
+
+    for (auto it = pendingSubtitles.begin(); it != pendingSubtitles.end(); ++it)
+    {
+        if (it.value() >= start)
         {
-            m_transcript->append(line);
+            it.value() += count;
+        }
+    }
+
+    for (auto &scanned : scannedTracks)
+    {
+        if (scanned.first >= start)
+        {
+            scanned.first += count;
         }
     }
 }
 
-void Player::drawSubtitles(QString subtitle)
+void Player::scanInsertedMedia()
 {
-    m_subtitles->setText(subtitle);
+    scanQueued = false;
+    m_scanner->scanFiles(unscannedMedia);
+    unscannedMedia.clear();
 }
 
-bool Player::isPlayerAvailable() const
+void Player::libraryMediaFound(const QStringList &files)
 {
-    return m_player->isAvailable();
+    QSet<QString> known;
+    for (int row = 0; row < m_playlist->mediaCount(); ++row)
+    {
+        known.insert(mediaFileAt(row));
+    }
+
+    QStringList added;
+    for (const QString &file : files)
+    {
+        if (!known.contains(file))
+        {
+            added.push_back(file);
+        }
+    }
+
+    appendMedia(added);
 }
 
-void Player::open()
+void Player::subtitlesScanned(const MediaScanner::Result &result)
 {
-    QFileDialog fileDialog(this);
-    fileDialog.setAcceptMode(QFileDialog::AcceptOpen);
-    fileDialog.setWindowTitle(tr("Open Files"));
-    fileDialog.setNameFilter(tr("Videos (*.mkv *.mp4 *.avi)"));
+    const QList<int> rows = pendingSubtitles.values(result.media);
+    pendingSubtitles.remove(result.media);
 
-    fileDialog.setDirectory(QStandardPaths::standardLocations(QStandardPaths::MoviesLocation).value(0, QDir::homePath()));
-    if (fileDialog.exec() == QDialog::Accepted)
+    const PlaylistModel::SubtitleStatus status = result.subtitle.isEmpty() ? PlaylistModel::SubtitlesNone
+            : result.subtitle == result.media ? PlaylistModel::SubtitlesEmbedded : PlaylistModel::SubtitlesSidecar;
+
+    for (int row : rows)
     {
-        addToPlaylist(fileDialog.selectedUrls());
+        //a subtitle file added by hand in the meantime wins
+        const SubtitleStore::Snapshot subtitles = m_subtitleStore.snapshot();
+        if (row >= subtitles->size() || !subtitles->tracks.at(row).isEmpty())
+        {
+            continue;
+        }
 
-        //read subtitle file
-        for (auto& url : fileDialog.selectedUrls())
+        m_playlistModel->setData(m_playlistModel->index(row, 0), status, PlaylistModel::SubtitleRole);
+        if (result.cues.isEmpty())
         {
-            QString path = url.toLocalFile();
-//            url.setPath(path);
-//            addToPlaylist(url);
+            continue;
+        }
 
-            if (QFileInfo(path).exists())
-            {
-                QString subtitle_FileName = QFileInfo(path).path() + "/" +
-                        QFileInfo(path).completeBaseName() + ".srt";
-
-                if (QFileInfo(subtitle_FileName).exists())
-                {
-                    QFile file(subtitle_FileName);
-                    if(!file.open(QIODevice::ReadOnly))
-                    {
-                        QMessageBox::information(0, "error", file.errorString());
-                        QStringList dummySub;
-                        subtitle_List.push_back(dummySub);
-                    }
-
-                    QTextStream in(&file);
-
-                    QStringList fullSubtitles;
-                    while(!in.atEnd())
-                    {
-                        fullSubtitles.push_back(in.readLine());
-                    }
-
-                    subtitle_List.push_back(fullSubtitles);
-
-                    file.close();
-                }
-                //if sub file doesn't exist, add empty sub to list
-                else
-                {
-                    //inform user that no subtitle file exists
-                    QMessageBox msgBox;
-                    msgBox.setWindowFlags(Qt::Popup);
-                    msgBox.setText("No .srt subtitle file found! "
-                                   "Please manually add an appropriate .srt file to access live subtitles and transcript.");
-                    msgBox.exec();
-
-                    QStringList dummySub;
-                    subtitle_List.push_back(dummySub);
-                }
-            }
+        scannedTracks.push_back(qMakePair(row, result.cues));
+    }
+
+    //every set() copies the whole track list, so a library scan would
+    //be quadratic if each file were published on its own
+    if (!scannedTracks.isEmpty() && !publishQueued)
+    {
+        publishQueued = true;
+        QTimer::singleShot(SCAN_PUBLISH_DELAY, this, &Player::publishScannedTracks);
+    }
+
+    if (!result.cues.isEmpty())
+    {
+        wordIndex()->addMedia(result.media, result.subtitle, result.cues);
+    }
+}
+
+void Player::publishScannedTracks()
+{
+    publishQueued = false;
+
+    //a subtitle file added by hand in the meantime wins
+    const SubtitleStore::Snapshot subtitles = m_subtitleStore.snapshot();
+    QVector<QPair<int, CueTable>> rows;
+    rows.reserve(scannedTracks.size());
+    for (const auto &scanned : qAsConst(scannedTracks))
+    {
+        if (scanned.first < subtitles->size() && subtitles->tracks.at(scanned.first).isEmpty())
+        {
+            rows.push_back(scanned);
         }
     }
+    scannedTracks.clear();
 
-    loadTranscript();
+    m_subtitleStore.setMany(rows);
+
+    bool current = false;
+    for (const auto &row : qAsConst(rows))
+    {
+        discardTranscript(row.first);
+        current = current || row.first == currentIndex;
+    }
+
+    if (current)
+    {
+        loadSubtitles();
+    }
+}
+
+void Player::scanFinished(int mediaFiles, int withoutSubtitles)
+{
+    //one summary instead of a popup per file
+    if (withoutSubtitles > 0)
+    {
+        setStatusInfo(tr("%1 of %2 videos have no subtitles; use \"Add subtitle file\" to add them")
+                      .arg(withoutSubtitles).arg(mediaFiles));
+    }
 }
 
 void Player::addSRT()
@@ -713,9 +961,9 @@ void Player::addSRT()
 
     QFileDialog fileDialog(this);
     fileDialog.setAcceptMode(QFileDialog::AcceptOpen);
-    fileDialog.setWindowTitle(tr("Add SRT file"));
+    fileDialog.setWindowTitle(tr("Add subtitle file"));
     fileDialog.setFileMode(QFileDialog::ExistingFile);
-    fileDialog.setNameFilter(tr("Subtitles (*.srt)"));
+    fileDialog.setNameFilter(tr("Subtitles (%1)").arg(SubtitleLoader::nameFilters().join(' ')));
 
     fileDialog.setDirectory(QStandardPaths::standardLocations(QStandardPaths::MoviesLocation).value(0, QDir::homePath()));
 
@@ -725,30 +973,43 @@ void Player::addSRT()
 
         for (auto subtitle_FileName : subtitle_Files)
         {
-            if (QFileInfo(subtitle_FileName).exists())
+            if (QFileInfo(subtitle_FileName).exists() && currentIndex < m_subtitleStore.snapshot()->size())
             {
-                QFile file(subtitle_FileName);
-                if(!file.open(QIODevice::ReadOnly))
-                {
-                    QMessageBox::information(0, "error", file.errorString());
-                }
+                const CueTable cues = readSubtitleFile(subtitle_FileName);
+                m_subtitleStore.set(currentIndex, cues);
+                discardTranscript(currentIndex);
+                wordIndex()->addMedia(mediaFileAt(currentIndex), subtitle_FileName, cues);
+            }
+        }
+    }
 
-                QTextStream in(&file);
+    loadSubtitles();
+}
 
-                QStringList fullSubtitles;
-                while(!in.atEnd())
-                {
-                    fullSubtitles.push_back(in.readLine());
-                }
+CueTable Player::readSubtitleFile(const QString &fileName)
+{
+    QString errorString;
+    SubtitleLoader::Stats stats;
+    CueTable cues = SubtitleLoader::loadFile(fileName, &errorString, &stats);
 
-                subtitle_List[currentIndex] = fullSubtitles;
+    if (!errorString.isEmpty())
+    {
+        QMessageBox::information(0, "error", errorString);
+        return cues;
+    }
 
-                file.close();
-            }
-        }
+    const double seconds = qMax<qint64>(stats.elapsedNs, 1) / 1e9;
+    if (stats.cached)
+    {
+        qCInfo(lcStats) << "Mapped" << fileName << "from the cue cache:" << stats.cues << "cues in" << seconds * 1000 << "ms";
+        return cues;
     }
 
-    loadTranscript();
+    qCInfo(lcStats) << "Parsed" << fileName << "(" << SubtitleLoader::formatName(stats.format) << "):" << stats.cues << "cues," << stats.malformed << "malformed,"
+            << stats.bytes / (1024.0 * 1024.0) / seconds << "MB/s," << stats.cues / seconds << "cues/s,"
+            << stats.tokens / seconds << "tokens/s";
+
+    return cues;
 }
 
 static bool isPlaylist(const QUrl &url) // Check for ".m3u" playlists.
@@ -761,28 +1022,72 @@ static bool isPlaylist(const QUrl &url) // Check for ".m3u" playlists.
 
 void Player::addToPlaylist(const QList<QUrl>& urls)
 {
+    //consecutive media go in as one batch, so the model sees a single insert
+    QList<QMediaContent> media;
     for (auto url : urls)
     {
         if (isPlaylist(url))
         {
+            if (!media.isEmpty())
+            {
+                m_playlist->addMedia(media);
+                media.clear();
+            }
             m_playlist->load(url);
         }
         else
         {
-            m_playlist->addMedia(url);
+            media.push_back(QMediaContent(url));
         }
     }
+
+    if (!media.isEmpty())
+    {
+        m_playlist->addMedia(media);
+    }
 }
 
 void Player::setCustomAudioRole(const QString &role)
 {
     m_player->setCustomAudioRole(role);
+
+    //only worth listing the alternatives when the role is not one of them
+    const QStringList supported = m_player->supportedCustomAudioRoles();
+    if (!supported.contains(role))
+    {
+        qWarning() << "Custom audio role" << role << "is not supported; supported roles:" << supported;
+    }
+}
+
+bool Player::setOfflineDictionary(const QString &dumpFileName)
+{
+    if (!m_offlineDictionary)
+    {
+        m_offlineDictionary = new OfflineDictionary();
+    }
+
+    if (!m_offlineDictionary->openDump(dumpFileName))
+    {
+        return false;
+    }
+
+    if (m_prefetcher)
+    {
+        m_prefetcher->setBackend(m_offlineDictionary);
+    }
+    qInfo() << "Offline dictionary:" << m_offlineDictionary->size() << "entries from" << dumpFileName;
+    return true;
 }
 
 void Player::durationChanged(qint64 duration)
 {
     m_duration = duration / 1000;
     m_slider->setMaximum(m_duration);
+
+    if (currentIndex >= 0)
+    {
+        m_playlistModel->setData(m_playlistModel->index(currentIndex, 0), duration, PlaylistModel::DurationRole);
+    }
 }
 
 void Player::positionChanged(qint64 progress)
@@ -833,28 +1138,113 @@ void Player::playlistPositionChanged(int currentItem)
     currentIndex = currentItem;
     m_playlistView->setCurrentIndex(m_playlistModel->index(currentIndex, 0));
 
-    //load transcript
-    loadTranscript();
+    //load subtitles and transcript
+    loadSubtitles();
 
     m_transcript -> moveCursor(QTextCursor::Start) ;
 }
 
-void Player::seek(int seconds)
+QString Player::mediaFileAt(int index) const
 {
-    m_player->setPosition(seconds * 1000);
+    return m_playlist->media(index).request().url().toLocalFile();
+}
 
-    //reset cursor position so word finding can
-    //start from beginning of doc
-    auto cursor = m_transcript->textCursor();
-    cursor.setPosition(0);
-    m_transcript->setTextCursor(cursor);
+void Player::searchWord()
+{
+    m_searchResults->clear();
 
+    const QVector<WordIndex::Hit> hits = wordIndex()->find(m_searchEdit->text());
+    if (hits.isEmpty())
+    {
+        m_searchResults->addItem(tr("No matches"));
+        return;
+    }
+
+    //cue text is only at hand for files in the playlist
+    const SubtitleStore::Snapshot subtitles = m_subtitleStore.snapshot();
+    QHash<QString, int> rows;
+    for (int row = 0; row < m_playlist->mediaCount() && row < subtitles->size(); ++row)
+    {
+        rows.insert(mediaFileAt(row), row);
+    }
+
+    for (const WordIndex::Hit &hit : hits)
+    {
+        QString text = QFileInfo(hit.media).completeBaseName() + "  " + CueTable::formatTimestamp(hit.position);
+
+        const int row = rows.value(hit.media, -1);
+        if (row >= 0 && hit.cue < subtitles->tracks.at(row).size())
+        {
+            text += "\n" + subtitles->tracks.at(row).text(hit.cue).replace('\n', ' ');
+        }
+
+        QListWidgetItem *item = new QListWidgetItem(text, m_searchResults);
+        item->setData(Qt::UserRole, hit.media);
+        item->setData(Qt::UserRole + 1, hit.position);
+    }
+}
+
+void Player::searchResultActivated(QListWidgetItem *item)
+{
+    const QString media = item->data(Qt::UserRole).toString();
+    const qint64 position = item->data(Qt::UserRole + 1).toLongLong();
+    if (media.isEmpty())
+    {
+        return;
+    }
+
+    if (currentIndex >= 0 && mediaFileAt(currentIndex) == media)
+    {
+        m_player->setPosition(position);
+        m_player->play();
+        return;
+    }
+
+    int row = -1;
+    for (int i = 0; i < m_playlist->mediaCount(); ++i)
+    {
+        if (mediaFileAt(i) == media)
+        {
+            row = i;
+            break;
+        }
+    }
+
+    //indexed earlier but not in this session's playlist
+    if (row < 0)
+    {
+        if (!QFileInfo(media).exists())
+        {
+            setStatusInfo(tr("%1 is no longer available").arg(media));
+            return;
+        }
+
+        row = m_playlist->mediaCount();
+        openMedia({media});
+    }
+
+    //the position can only be set once the new file has loaded
+    pendingSeek = position;
+    m_playlist->setCurrentIndex(row);
+    m_player->play();
+}
+
+void Player::seek(int seconds)
+{
+    m_player->setPosition(seconds * 1000);
 }
 
 void Player::statusChanged(QMediaPlayer::MediaStatus status)
 {
     handleCursor(status);
 
+    //a search hit in another file seeks once that file is loaded
+    if (pendingSeek >= 0 && (status == QMediaPlayer::LoadedMedia || status == QMediaPlayer::BufferedMedia))
+    {
+        m_player->setPosition(pendingSeek);
+        pendingSeek = -1;
+    }
+
     // handle status message
     switch (status) {
     case QMediaPlayer::UnknownMediaStatus:
@@ -54,16 +54,25 @@
 #include <QWidget>
 #include <QMediaPlayer>
 #include <QMediaPlaylist>
-#include <thread>
+#include <QTextBlock>
 #include <QTextCursor>
 #include <QNetworkAccessManager>
+#include <QNetworkReply>
 #include <QHBoxLayout>
 #include <QScrollArea>
 #include <QMenu>
+#include <QMultiHash>
+
+#include "cuetable.h"
+#include "mediascanner.h"
+#include "subtitlestore.h"
 
 QT_BEGIN_NAMESPACE
 class QAbstractItemView;
 class QLabel;
+class QLineEdit;
+class QListWidget;
+class QListWidgetItem;
 class QTextEdit;
 class QMediaPlayer;
 class QModelIndex;
@@ -71,12 +80,19 @@ class QPushButton;
 class QSlider;
 class QStatusBar;
 class QVideoProbe;
-class QVideoWidget;
 class QAudioProbe;
 QT_END_NAMESPACE
 
 class PlaylistModel;
 class HistogramWidget;
+class PlaybackClock;
+class SubtitleScheduler;
+class DictionaryCache;
+class DictionaryClient;
+class OfflineDictionary;
+class DefinitionPrefetcher;
+class VideoWidget;
+class WordIndex;
 
 class Player : public QWidget
 {
@@ -90,12 +106,17 @@ public:
 
     void addToPlaylist(const QList<QUrl> &urls);
     void setCustomAudioRole(const QString &role);
-
-signals:
-    void drawSubtitles_signal(QString subtitle);
+    bool setOfflineDictionary(const QString &dumpFileName);
+    void openMedia(const QStringList &files);
+    void scanLibrary(const QStringList &directories);
 
 private slots:
     void open();
+    void openFolder();
+    void libraryMediaFound(const QStringList &files);
+    void playlistMediaInserted(int start, int end);
+    void subtitlesScanned(const MediaScanner::Result &result);
+    void scanFinished(int mediaFiles, int withoutSubtitles);
     void durationChanged(qint64 duration);
     void positionChanged(qint64 progress);
     void metaDataChanged();
@@ -111,19 +132,19 @@ private slots:
     //void videoAvailableChanged(bool available);
 
     void displayErrorMessage();
-    void drawSubtitles(QString subtitle);
     void wordHighlighted(bool yes);
+    void lookupWord(const QString &word);
 
-    void managerFinished(QNetworkReply *reply);
+    void definitionFetched(const QString &language, const QString &word,
+                           QNetworkReply::NetworkError error, const QByteArray &answer);
+
+    void searchWord();
+    void searchResultActivated(QListWidgetItem *item);
 
 private:
-    qint64 SRTStartTime_to_milliseconds(QString subtitle_time);
-    qint64 SRTEndTime_to_milliseconds(QString subtitle_time);
-    bool isWithinSubPeriod(qint64 curPos, QString subtitle_time);
     QString format_time(int time);
-    void processSubtitles();
-    void highlight_currentLine();
     void loadTranscript();
+    void loadSubtitles();
 
     void setTrackInfo(const QString &info);
     void setStatusInfo(const QString &info);
@@ -134,7 +155,7 @@ private:
 
     QMediaPlayer *m_player = nullptr;
     QMediaPlaylist *m_playlist = nullptr;
-    QVideoWidget *m_videoWidget = nullptr;
+    VideoWidget *m_videoWidget = nullptr;
     QLabel *m_coverLabel = nullptr;
     QSlider *m_slider = nullptr;
     QLabel *m_labelDuration = nullptr;
@@ -150,36 +171,71 @@ private:
 
     //subtitles
     int currentIndex;
-    QTextEdit * m_subtitles = nullptr;
-    QList<QStringList> subtitle_List;
+    SubtitleStore m_subtitleStore;
     void addSRT();
-
-    //thread to draw subs
-    std::thread subtitle_thread;
-    std::thread highlightline_thread;
-    bool threadRun = true;
+    CueTable readSubtitleFile(const QString &fileName);
+    void appendMedia(const QStringList &files);
+    MediaScanner *m_scanner = nullptr;
+    QMultiHash<QString, int> pendingSubtitles;  //media file -> rows waiting for the scanner
+    QStringList unscannedMedia;                 //inserted rows not yet handed to the scanner
+    bool scanQueued = false;
+    void scanInsertedMedia();
+    QVector<QPair<int, CueTable>> scannedTracks; //scanner results not yet published
+    bool publishQueued = false;
+    void publishScannedTracks();
+    PlaybackClock *m_clock = nullptr;
+    QVideoProbe *m_videoProbe = nullptr;
+    SubtitleScheduler *m_subtitleScheduler = nullptr;
+
+    //library-wide word search
+    WordIndex *m_wordIndex = nullptr;
+    WordIndex *wordIndex();
+    QLineEdit *m_searchEdit = nullptr;
+    QListWidget *m_searchResults = nullptr;
+    qint64 pendingSeek = -1;
+    QString mediaFileAt(int index) const;
 
     //cursor
-    void moveScrollBar();
-    void setTranscriptPosition();
+    void moveScrollBar(const QTextBlock &block);
+    void setTranscriptPosition(int cue);
+
+    //transcript documents are built once per track and swapped in on track change
+    struct Transcript
+    {
+        QTextDocument *document = nullptr;
+        QVector<QTextBlock> blocks; //timing line of each cue
+    };
+    QVector<Transcript> transcript_List;
+    QTextDocument *emptyTranscript = nullptr;
+    void buildTranscript(const CueTable &cues, Transcript *transcript);
+    void discardTranscript(int index);
+    void shiftRows(int start, int count);
 
     //dictionary API
-    const QByteArray app_id = "a74a5872";
-    const QByteArray app_key = "46564d304f6f015945afbc97336f4f3c";
-    QNetworkAccessManager *manager = nullptr;
-    QNetworkRequest request;
-    QNetworkReply *reply;
+    const QString language_code = "en-gb";
+    DictionaryCache *m_dictionaryCache = nullptr;
+    OfflineDictionary *m_offlineDictionary = nullptr;
+    DefinitionPrefetcher *m_prefetcher = nullptr;
+    DictionaryClient *m_dictionaryClient = nullptr;
+    QString pendingWord;
+    QStringList pendingFallbacks;
+    quint64 lookupId = 0;
+    bool pausedForLookup = false;
     QString curSelectedWord;
-    void APIRequest();
-    QString parse_JSON_Response(QByteArray answer);
-
-    //dictionary popup
-    QByteArray dict_answer;
-    QString outputString;
-    QDialog* definition_dialog;
-    QTextEdit* dictionaryOutput;
-    QHBoxLayout* dialog_layout;
-    QScrollArea* scroll;
+    DictionaryCache *dictionaryCache();
+    DictionaryClient *dictionaryClient();
+    DefinitionPrefetcher *prefetcher();
+    void APIRequest(const QString &selection);
+    static QString parse_JSON_Response(const QByteArray &answer);
+    void showDefinition(quint64 id, const QByteArray &answer);
+    void showDefinitionText(const QString &html);
+
+    //dictionary popup, built on the first lookup
+    QDialog* definition_dialog = nullptr;
+    QTextEdit* dictionaryOutput = nullptr;
+    QHBoxLayout* dialog_layout = nullptr;
+    QScrollArea* scroll = nullptr;
+    void createDefinitionDialog();
 
     //right click menu
     bool isDefMenu_constructed = false;
@@ -1,23 +1,85 @@
 TEMPLATE = app
 TARGET = player
 
-QT += network \
+QT += concurrent \
+      network \
       xml \
       multimedia \
       multimediawidgets \
       widgets
 
 CONFIG += debug
+CONFIG += c++14
 
 HEADERS = \
+    assparser.h \
+    benchmark.h \
+    cuecache.h \
+    cuetable.h \
+    definitionparser.h \
+    definitionprefetcher.h \
+    dictionaryapi.h \
+    dictionarybackend.h \
+    dictionarycache.h \
+    dictionaryclient.h \
+    dictionaryloadtest.h \
+    embeddedsubtitles.h \
+    lemmatizer.h \
+    logging.h \
+    matroskareader.h \
+    mediascanner.h \
+    mockdictionarynetwork.h \
+    mp4reader.h \
+    offlinedictionary.h \
+    playbackclock.h \
     player.h \
     playercontrols.h \
     playlistmodel.h \
-    videowidget.h
+    srtparser.h \
+    startupprofiler.h \
+    subtitleloader.h \
+    subtitleoverlay.h \
+    subtitleparsers_p.h \
+    subtitlescheduler.h \
+    subtitlestore.h \
+    subtitlewords.h \
+    videowidget.h \
+    vocabularyextractor.h \
+    webvttparser.h \
+    wordindex.h
 SOURCES = main.cpp \
+    assparser.cpp \
+    benchmark.cpp \
+    cuecache.cpp \
+    cuetable.cpp \
+    definitionparser.cpp \
+    definitionprefetcher.cpp \
+    dictionaryapi.cpp \
+    dictionarycache.cpp \
+    dictionaryclient.cpp \
+    dictionaryloadtest.cpp \
+    embeddedsubtitles.cpp \
+    lemmatizer.cpp \
+    logging.cpp \
+    matroskareader.cpp \
+    mediascanner.cpp \
+    mockdictionarynetwork.cpp \
+    mp4reader.cpp \
+    offlinedictionary.cpp \
+    playbackclock.cpp \
     player.cpp \
     playercontrols.cpp \
     playlistmodel.cpp \
-    videowidget.cpp
+    srtparser.cpp \
+    startupprofiler.cpp \
+    subtitleloader.cpp \
+    subtitleoverlay.cpp \
+    subtitlescheduler.cpp \
+    subtitlestore.cpp \
+    subtitlewords.cpp \
+    videowidget.cpp \
+    vocabularyextractor.cpp \
+    webvttparser.cpp \
+    wordindex.cpp
 
 TARGET = VideoToInstantDictionary
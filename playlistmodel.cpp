@@ -50,9 +50,18 @@
 
 #include "playlistmodel.h"
 
+#include "embeddedsubtitles.h"
+#include "subtitleloader.h"
+
+#include <QDir>
 #include <QFileInfo>
+#include <QFutureWatcher>
+#include <QLocale>
+#include <QSet>
+#include <QTime>
 #include <QUrl>
 #include <QMediaPlaylist>
+#include <QtConcurrent/QtConcurrent>
 
 PlaylistModel::PlaylistModel(QObject *parent)
     : QAbstractItemModel(parent)
@@ -65,7 +74,7 @@ PlaylistModel::~PlaylistModel()
 
 int PlaylistModel::rowCount(const QModelIndex &parent) const
 {
-    return m_playlist && !parent.isValid() ? m_playlist->mediaCount() : 0;
+    return m_playlist && !parent.isValid() ? m_entries.size() : 0;
 }
 
 int PlaylistModel::columnCount(const QModelIndex &parent) const
@@ -76,7 +85,7 @@ int PlaylistModel::columnCount(const QModelIndex &parent) const
 QModelIndex PlaylistModel::index(int row, int column, const QModelIndex &parent) const
 {
     return m_playlist && !parent.isValid()
-            && row >= 0 && row < m_playlist->mediaCount()
+            && row >= 0 && row < m_entries.size()
             && column >= 0 && column < ColumnCount
         ? createIndex(row, column)
         : QModelIndex();
@@ -91,14 +100,21 @@ QModelIndex PlaylistModel::parent(const QModelIndex &child) const
 
 QVariant PlaylistModel::data(const QModelIndex &index, int role) const
 {
-    if (index.isValid() && role == Qt::DisplayRole) {
-        QVariant value = m_data[index];
-        if (!value.isValid() && index.column() == Title) {
-            QUrl location = m_playlist->media(index.row()).canonicalUrl();
-            return QFileInfo(location.path()).fileName();
-        }
+    if (!index.isValid() || index.row() >= m_entries.size())
+        return QVariant();
 
-        return value;
+    const Entry &entry = m_entries.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return entry.display.isValid() || index.column() != Title ? entry.display : entry.title;
+    case Qt::ToolTipRole:
+        return tooltip(entry);
+    case DurationRole:
+        return entry.duration;
+    case SubtitleRole:
+        return entry.subtitles;
+    case FileSizeRole:
+        return entry.fileSize;
     }
     return QVariant();
 }
@@ -120,6 +136,7 @@ void PlaylistModel::setPlaylist(QMediaPlaylist *playlist)
 
     beginResetModel();
     m_playlist.reset(playlist);
+    m_entries.clear();
 
     if (m_playlist) {
         connect(m_playlist.data(), &QMediaPlaylist::mediaAboutToBeInserted, this, &PlaylistModel::beginInsertItems);
@@ -127,43 +144,208 @@ void PlaylistModel::setPlaylist(QMediaPlaylist *playlist)
         connect(m_playlist.data(), &QMediaPlaylist::mediaAboutToBeRemoved, this, &PlaylistModel::beginRemoveItems);
         connect(m_playlist.data(), &QMediaPlaylist::mediaRemoved, this, &PlaylistModel::endRemoveItems);
         connect(m_playlist.data(), &QMediaPlaylist::mediaChanged, this, &PlaylistModel::changeItems);
+
+        m_entries.resize(m_playlist->mediaCount());
+        resetEntries(0, m_entries.size() - 1);
     }
 
     endResetModel();
+
+    probe(0, m_entries.size() - 1);
 }
 
 bool PlaylistModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    Q_UNUSED(role);
-    m_data[index] = value;
+    if (!index.isValid() || index.row() >= m_entries.size())
+        return false;
+
+    Entry &entry = m_entries[index.row()];
+    switch (role) {
+    case DurationRole:
+        entry.duration = value.toLongLong();
+        break;
+    case SubtitleRole:
+        entry.subtitles = SubtitleStatus(value.toInt());
+        break;
+    case FileSizeRole:
+        entry.fileSize = value.toLongLong();
+        break;
+    default:
+        entry.display = value;
+        break;
+    }
+
     emit dataChanged(index, index);
     return true;
 }
 
 void PlaylistModel::beginInsertItems(int start, int end)
 {
-    m_data.clear();
+    //the media is only in the playlist once mediaInserted arrives
     beginInsertRows(QModelIndex(), start, end);
+    m_entries.insert(start, end - start + 1, Entry());
+    m_insertStart = start;
+    m_insertEnd = end;
 }
 
 void PlaylistModel::endInsertItems()
 {
+    resetEntries(m_insertStart, m_insertEnd);
     endInsertRows();
+
+    probe(m_insertStart, m_insertEnd);
 }
 
 void PlaylistModel::beginRemoveItems(int start, int end)
 {
-    m_data.clear();
     beginRemoveRows(QModelIndex(), start, end);
+    m_entries.remove(start, end - start + 1);
 }
 
 void PlaylistModel::endRemoveItems()
 {
-    endInsertRows();
+    endRemoveRows();
 }
 
 void PlaylistModel::changeItems(int start, int end)
 {
-    m_data.clear();
-    emit dataChanged(index(start,0), index(end,ColumnCount));
+    resetEntries(start, end);
+    emit dataChanged(index(start, 0), index(end, ColumnCount - 1));
+
+    probe(start, end);
+}
+
+void PlaylistModel::resetEntries(int start, int end)
+{
+    for (int row = start; row <= end && row < m_entries.size(); ++row) {
+        Entry &entry = m_entries[row];
+        entry = Entry();
+        entry.id = ++m_nextId;
+        entry.title = m_playlist->media(row).request().url().fileName();
+    }
+}
+
+void PlaylistModel::probe(int start, int end)
+{
+    //the whole range goes to one task, so a folder shared by many rows is listed once
+    QVector<Probe> probes;
+    probes.reserve(qMax(0, end - start + 1));
+
+    for (int row = start; row <= end; ++row) {
+        const QUrl url = m_playlist->media(row).request().url();
+        if (url.isLocalFile())
+            probes.push_back({m_entries.at(row).id, row, url.toLocalFile(), -1, SubtitlesUnknown});
+    }
+
+    if (probes.isEmpty())
+        return;
+
+    auto watcher = new QFutureWatcher<QVector<Probe>>(this);
+    connect(watcher, &QFutureWatcher<QVector<Probe>>::finished, this, [this, watcher]() {
+        watcher->deleteLater();
+        applyProbes(watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run(&PlaylistModel::probeFiles, probes));
+}
+
+QVector<PlaylistModel::Probe> PlaylistModel::probeFiles(QVector<Probe> probes)
+{
+    //one directory listing answers the size and sidecar questions for every file in it
+    struct Listing
+    {
+        QHash<QString, qint64> sizes;
+        QSet<QString> lowerNames;   //sidecars match in any case: Movie.SRT
+    };
+    QHash<QString, Listing> listings;
+
+    for (Probe &probe : probes) {
+        const QFileInfo info(probe.fileName);
+
+        auto listing = listings.find(info.path());
+        if (listing == listings.end()) {
+            Listing files;
+            for (const QFileInfo &file : QDir(info.path()).entryInfoList(QDir::Files)) {
+                files.sizes.insert(file.fileName(), file.size());
+                files.lowerNames.insert(file.fileName().toLower());
+            }
+            listing = listings.insert(info.path(), files);
+        }
+
+        probe.fileSize = listing->sizes.value(info.fileName(), -1);
+        probe.subtitles = SubtitlesNone;
+        const QString baseName = info.completeBaseName().toLower() + '.';
+        for (const QString &suffix : SubtitleLoader::suffixes()) {
+            if (listing->lowerNames.contains(baseName + suffix)) {
+                probe.subtitles = SubtitlesSidecar;
+                break;
+            }
+        }
+
+        if (probe.subtitles == SubtitlesNone && EmbeddedSubtitles::canRead(probe.fileName))
+            probe.subtitles = SubtitlesEmbedded;
+    }
+
+    return probes;
+}
+
+void PlaylistModel::applyProbes(const QVector<Probe> &probes)
+{
+    int first = m_entries.size();
+    int last = -1;
+    int shift = 0;
+
+    for (const Probe &probe : probes) {
+        //rows inserted or removed meanwhile move the whole batch by the same amount
+        int row = probe.row + shift;
+        if (row < 0 || row >= m_entries.size() || m_entries.at(row).id != probe.id) {
+            row = -1;
+            for (int i = 0; i < m_entries.size(); ++i) {
+                if (m_entries.at(i).id == probe.id) {
+                    row = i;
+                    break;
+                }
+            }
+            if (row < 0)
+                continue;
+            shift = row - probe.row;
+        }
+
+        Entry &entry = m_entries[row];
+        entry.fileSize = probe.fileSize;
+        if (entry.subtitles == SubtitlesUnknown)
+            entry.subtitles = probe.subtitles;
+
+        first = qMin(first, row);
+        last = qMax(last, row);
+    }
+
+    if (last >= 0)
+        emit dataChanged(index(first, 0), index(last, ColumnCount - 1));
+}
+
+QString PlaylistModel::tooltip(const Entry &entry) const
+{
+    QStringList lines;
+    lines << (entry.display.isValid() ? entry.display.toString() : entry.title);
+
+    if (entry.duration >= 0)
+        lines << tr("Duration: %1").arg(QTime(0, 0).addMSecs(int(entry.duration)).toString("hh:mm:ss"));
+    if (entry.fileSize >= 0)
+        lines << tr("Size: %1").arg(QLocale().formattedDataSize(entry.fileSize));
+
+    switch (entry.subtitles) {
+    case SubtitlesSidecar:
+        lines << tr("Subtitles: file");
+        break;
+    case SubtitlesEmbedded:
+        lines << tr("Subtitles: embedded track");
+        break;
+    case SubtitlesNone:
+        lines << tr("Subtitles: none");
+        break;
+    case SubtitlesUnknown:
+        break;
+    }
+
+    return lines.join('\n');
 }
@@ -53,6 +53,7 @@
 
 #include <QAbstractItemModel>
 #include <QScopedPointer>
+#include <QVector>
 
 QT_BEGIN_NAMESPACE
 class QMediaPlaylist;
@@ -69,6 +70,21 @@ public:
         ColumnCount
     };
 
+    enum Role
+    {
+        DurationRole = Qt::UserRole,    //ms, -1 until known
+        SubtitleRole,                   //SubtitleStatus
+        FileSizeRole                    //bytes, -1 until known
+    };
+
+    enum SubtitleStatus
+    {
+        SubtitlesUnknown,
+        SubtitlesSidecar,
+        SubtitlesEmbedded,  //container that may carry a text track
+        SubtitlesNone
+    };
+
     explicit PlaylistModel(QObject *parent = nullptr);
     ~PlaylistModel();
 
@@ -93,8 +109,38 @@ private slots:
     void changeItems(int start, int end);
 
 private:
+    //one per playlist row, in row order
+    struct Entry
+    {
+        quint32 id = 0;
+        QString title;
+        QVariant display;   //setData() override of the title
+        qint64 duration = -1;
+        qint64 fileSize = -1;
+        SubtitleStatus subtitles = SubtitlesUnknown;
+    };
+
+    //file system facts gathered off the GUI thread
+    struct Probe
+    {
+        quint32 id;
+        int row;            //row when queued; rows may have moved since
+        QString fileName;
+        qint64 fileSize;
+        SubtitleStatus subtitles;
+    };
+
+    void resetEntries(int start, int end);
+    void probe(int start, int end);
+    void applyProbes(const QVector<Probe> &probes);
+    static QVector<Probe> probeFiles(QVector<Probe> probes);
+    QString tooltip(const Entry &entry) const;
+
     QScopedPointer<QMediaPlaylist> m_playlist;
-    QMap<QModelIndex, QVariant> m_data;
+    QVector<Entry> m_entries;
+    quint32 m_nextId = 0;
+    int m_insertStart = -1;
+    int m_insertEnd = -1;
 };
 
 #endif // PLAYLISTMODEL_H
@@ -0,0 +1,92 @@
+#include "srtparser.h"
+
+#include "subtitleparsers_p.h"
+
+using namespace SubtitleText;
+
+CueTable SrtParser::parseText(const QString &text, int *malformed)
+{
+    const QChar *data = text.constData();
+    const int size = text.size();
+
+    CueTable cues;
+    cues.reserve(size / 48, size / 2);
+
+    int skipped = 0;
+    int pos = skipBom(data, size);
+
+    while (pos < size)
+    {
+        Line line = lineAt(data, size, pos);
+        pos = line.next;
+
+        if (isBlank(data, line))
+        {
+            continue;
+        }
+
+        //cue number is optional in practice
+        if (isIndex(data, line) && pos < size)
+        {
+            line = lineAt(data, size, pos);
+            pos = line.next;
+        }
+
+        const int arrow = findArrow(data, line);
+        bool startOk = false;
+        bool endOk = false;
+        qint64 start = 0;
+        qint64 end = 0;
+
+        if (arrow >= 0)
+        {
+            start = CueTable::parseTimestamp(QStringRef(&text, line.begin, arrow - line.begin).trimmed(), &startOk);
+            end = CueTable::parseTimestamp(QStringRef(&text, arrow + 3, line.end - arrow - 3).trimmed(), &endOk);
+        }
+
+        //text runs to the next blank line, or to the next "index + timing" pair
+        //when the blank separator is missing
+        const int textBegin = pos;
+        int textEnd = pos;
+        while (pos < size)
+        {
+            const Line textLine = lineAt(data, size, pos);
+            if (isBlank(data, textLine))
+            {
+                break;
+            }
+
+            if (isIndex(data, textLine) && textLine.next < size
+                    && findArrow(data, lineAt(data, size, textLine.next)) >= 0)
+            {
+                break;
+            }
+
+            if (findArrow(data, textLine) >= 0)
+            {
+                break;
+            }
+
+            textEnd = textLine.end;
+            pos = textLine.next;
+        }
+
+        if (!startOk || !endOk)
+        {
+            ++skipped;
+            continue;
+        }
+
+        cues.append(start, end, data + textBegin, textEnd - textBegin);
+    }
+
+    cues.sort();
+    cues.squeeze();
+
+    if (malformed)
+    {
+        *malformed = skipped;
+    }
+
+    return cues;
+}
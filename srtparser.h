@@ -0,0 +1,17 @@
+#ifndef SRTPARSER_H
+#define SRTPARSER_H
+
+#include "cuetable.h"
+
+//Single-pass SubRip (.srt) tokeniser.
+//Cues are cut straight out of the decoded buffer into the CueTable
+//without any per-line strings. Handles CRLF, multi-line cues, missing
+//cue numbers or blank separators, and skips blocks with malformed
+//timestamps. File access and decoding live in SubtitleLoader.
+class SrtParser
+{
+public:
+    static CueTable parseText(const QString &text, int *malformed = nullptr);
+};
+
+#endif // SRTPARSER_H
@@ -0,0 +1,146 @@
+#include "startupprofiler.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QMediaPlayer>
+#include <QTimer>
+#include <QVector>
+#include <QVideoProbe>
+#include <QWidget>
+
+namespace StartupProfiler
+{
+
+namespace {
+
+struct Mark
+{
+    const char *phase;
+    qint64 nsecs;
+};
+
+QElapsedTimer timer;
+QVector<Mark> marks;
+bool enabled = false;
+bool mediaLoaded = false;
+bool firstFrame = false;
+
+//removes itself after the first paint of the watched window
+class PaintWatcher : public QObject
+{
+public:
+    explicit PaintWatcher(QObject *window)
+        : QObject(window)
+    {
+    }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if (event->type() == QEvent::Paint && watched == parent())
+        {
+            watched->removeEventFilter(this);
+            deleteLater();
+
+            //the backing store is flushed once the paint event returns
+            QTimer::singleShot(0, []()
+            {
+                mark("first paint");
+                report();
+            });
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+void start()
+{
+    timer.start();
+    marks.reserve(32);
+}
+
+void setEnabled(bool enable)
+{
+    enabled = enable;
+}
+
+bool isEnabled()
+{
+    return enabled;
+}
+
+void mark(const char *phase)
+{
+    if (timer.isValid())
+    {
+        marks.append(Mark{phase, timer.nsecsElapsed()});
+    }
+}
+
+void watchFirstPaint(QWidget *window)
+{
+    if (enabled)
+    {
+        window->installEventFilter(new PaintWatcher(window));
+    }
+}
+
+void watchFirstFrame(QMediaPlayer *player, QVideoProbe *probe)
+{
+    if (!enabled)
+    {
+        return;
+    }
+
+    //without a probe there is no frame to wait for, so loading is the end
+    const bool last = !probe;
+    QObject::connect(player, &QMediaPlayer::mediaStatusChanged, player, [last](QMediaPlayer::MediaStatus status)
+    {
+        if (!mediaLoaded && (status == QMediaPlayer::LoadedMedia || status == QMediaPlayer::BufferedMedia))
+        {
+            mediaLoaded = true;
+            mark("media loaded");
+            if (last)
+            {
+                report();
+            }
+        }
+    });
+
+    if (probe)
+    {
+        QObject::connect(probe, &QVideoProbe::videoFrameProbed, probe, []()
+        {
+            if (!firstFrame)
+            {
+                firstFrame = true;
+                mark("first frame");
+                report();
+            }
+        });
+    }
+}
+
+void report()
+{
+    if (!enabled)
+    {
+        return;
+    }
+
+    qInfo() << "Startup profile:";
+    qint64 previous = 0;
+    for (const Mark &entry : marks)
+    {
+        qInfo().noquote() << QString("    %1 %2 ms (+%3 ms)")
+                             .arg(QLatin1String(entry.phase), -16)
+                             .arg(entry.nsecs / 1e6, 8, 'f', 1)
+                             .arg((entry.nsecs - previous) / 1e6, 0, 'f', 1);
+        previous = entry.nsecs;
+    }
+}
+
+} // namespace StartupProfiler
@@ -0,0 +1,35 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QtGlobal>
+
+QT_BEGIN_NAMESPACE
+class QMediaPlayer;
+class QVideoProbe;
+class QWidget;
+QT_END_NAMESPACE
+
+//Phase timings from process start to the first painted window and the
+//first video frame, for --profile-startup.
+//mark() closes the phase running since the previous mark; marks are
+//always recorded (one clock read each) so phases before the command line
+//is parsed are covered, but nothing is watched or printed unless enabled.
+namespace StartupProfiler
+{
+
+void start();
+void setEnabled(bool enabled);
+bool isEnabled();
+
+void mark(const char *phase);
+
+//marks "first paint" once the window's first paint has been flushed
+void watchFirstPaint(QWidget *window);
+//marks "media loaded" and "first frame"; the probe may be null
+void watchFirstFrame(QMediaPlayer *player, QVideoProbe *probe);
+
+void report();
+
+} // namespace StartupProfiler
+
+#endif // STARTUPPROFILER_H
@@ -0,0 +1,186 @@
+#include "subtitleloader.h"
+
+#include "assparser.h"
+#include "cuecache.h"
+#include "srtparser.h"
+#include "webvttparser.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextCodec>
+
+CueTable SubtitleLoader::loadFile(const QString &fileName, QString *errorString, Stats *stats)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        if (errorString)
+        {
+            *errorString = file.errorString();
+        }
+        return CueTable();
+    }
+
+    const qint64 size = file.size();
+    if (size <= 0)
+    {
+        return CueTable();
+    }
+
+    //a previously parsed file comes back as a view into its cache entry
+    const CueCache cache;
+    CueTable cues;
+    QElapsedTimer timer;
+    timer.start();
+
+    if (cache.load(fileName, &cues))
+    {
+        if (stats)
+        {
+            stats->bytes = size;
+            stats->cues = cues.size();
+            stats->tokens = cues.tokenBufferSize();
+            stats->cached = true;
+            stats->elapsedNs = timer.nsecsElapsed();
+        }
+        return cues;
+    }
+
+    //map instead of reading so the only copy is the decode itself
+    if (uchar *mapped = file.map(0, size))
+    {
+        cues = load(reinterpret_cast<const char *>(mapped), size, stats);
+        file.unmap(mapped);
+    }
+    else
+    {
+        cues = load(file.readAll(), stats);
+    }
+
+    cache.store(fileName, cues);
+    return cues;
+}
+
+CueTable SubtitleLoader::load(const QByteArray &data, Stats *stats)
+{
+    return load(data.constData(), data.size(), stats);
+}
+
+CueTable SubtitleLoader::load(const char *data, qint64 size, Stats *stats)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    //BOM sniffing picks UTF-16/32 when present, otherwise UTF-8
+    QTextCodec *codec = QTextCodec::codecForUtfText(QByteArray::fromRawData(data, int(size)),
+                                                    QTextCodec::codecForName("UTF-8"));
+    CueTable cues = parseText(codec->toUnicode(data, int(size)), stats);
+
+    if (stats)
+    {
+        stats->bytes = size;
+        stats->elapsedNs = timer.nsecsElapsed();
+    }
+
+    return cues;
+}
+
+CueTable SubtitleLoader::parseText(const QString &text, Stats *stats)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const Format format = sniff(text);
+    int malformed = 0;
+    CueTable cues;
+
+    switch (format)
+    {
+    case WebVtt:
+        cues = WebVttParser::parseText(text, &malformed);
+        break;
+    case SubStationAlpha:
+        cues = AssParser::parseText(text, &malformed);
+        break;
+    case SubRip:
+    case Unknown:
+        //SRT is the most forgiving parser, so it gets anything unrecognised
+        cues = SrtParser::parseText(text, &malformed);
+        break;
+    }
+
+    if (stats)
+    {
+        stats->format = format;
+        stats->bytes = text.size() * qint64(sizeof(QChar));
+        stats->cues = cues.size();
+        stats->tokens = cues.tokenBufferSize();
+        stats->malformed = malformed;
+        stats->elapsedNs = timer.nsecsElapsed();
+    }
+
+    return cues;
+}
+
+SubtitleLoader::Format SubtitleLoader::sniff(const QString &text)
+{
+    //only the head of the file is looked at
+    const QStringRef head = text.leftRef(4096);
+
+    int pos = 0;
+    while (pos < head.size() && (head.at(pos) == QChar(0xFEFF) || head.at(pos).isSpace()))
+    {
+        ++pos;
+    }
+
+    const QStringRef start = head.mid(pos);
+    if (start.startsWith(QLatin1String("WEBVTT")))
+    {
+        return WebVtt;
+    }
+
+    if (start.startsWith(QLatin1String("[Script Info]"), Qt::CaseInsensitive)
+            || head.contains(QLatin1String("[V4"), Qt::CaseInsensitive)
+            || head.contains(QLatin1String("[Events]"), Qt::CaseInsensitive))
+    {
+        return SubStationAlpha;
+    }
+
+    if (head.contains(QLatin1String("-->")))
+    {
+        return SubRip;
+    }
+
+    return Unknown;
+}
+
+QString SubtitleLoader::formatName(Format format)
+{
+    switch (format)
+    {
+    case SubRip:
+        return QStringLiteral("SubRip");
+    case WebVtt:
+        return QStringLiteral("WebVTT");
+    case SubStationAlpha:
+        return QStringLiteral("SubStation Alpha");
+    case Unknown:
+        break;
+    }
+    return QStringLiteral("unknown");
+}
+
+QStringList SubtitleLoader::suffixes()
+{
+    return {QStringLiteral("srt"), QStringLiteral("vtt"), QStringLiteral("ass"), QStringLiteral("ssa")};
+}
+
+QStringList SubtitleLoader::nameFilters()
+{
+    QStringList filters;
+    for (const QString &suffix : suffixes())
+    {
+        filters.push_back(QStringLiteral("*.") + suffix);
+    }
+    return filters;
+}
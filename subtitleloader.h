@@ -0,0 +1,50 @@
+#ifndef SUBTITLELOADER_H
+#define SUBTITLELOADER_H
+
+#include "cuetable.h"
+
+#include <QStringList>
+
+//Front door for subtitle files.
+//The file is memory-mapped and decoded once (BOM-aware, UTF-8 otherwise),
+//the format is sniffed from the content rather than the suffix, and the
+//matching single-pass parser fills a CueTable. Every format ends up in the
+//same table so the scheduler, transcript and prefetcher never care where
+//the cues came from. Parsed files are kept in a CueCache, so re-opening
+//an unchanged file skips decoding and parsing altogether.
+class SubtitleLoader
+{
+public:
+    enum Format
+    {
+        Unknown,
+        SubRip,
+        WebVtt,
+        SubStationAlpha
+    };
+
+    struct Stats
+    {
+        Format format = Unknown;
+        qint64 bytes = 0;
+        int cues = 0;
+        int tokens = 0;     //word spans found while appending the cues
+        int malformed = 0;
+        qint64 elapsedNs = 0;
+        bool cached = false;    //served from CueCache, format unknown
+    };
+
+    static CueTable loadFile(const QString &fileName, QString *errorString = nullptr, Stats *stats = nullptr);
+    static CueTable load(const QByteArray &data, Stats *stats = nullptr);
+    static CueTable load(const char *data, qint64 size, Stats *stats = nullptr);
+    static CueTable parseText(const QString &text, Stats *stats = nullptr);
+
+    static Format sniff(const QString &text);
+    static QString formatName(Format format);
+
+    //sidecar suffixes in order of preference, and a matching dialog filter
+    static QStringList suffixes();
+    static QStringList nameFilters();
+};
+
+#endif // SUBTITLELOADER_H
@@ -0,0 +1,257 @@
+#include "subtitleoverlay.h"
+
+#include <QFontMetricsF>
+#include <QMouseEvent>
+#include <QPainter>
+
+//space around the text, in pixels
+static const int MARGIN = 8;
+
+//cached layouts kept before the cache starts over
+static const int MAX_LAYOUTS = 256;
+
+SubtitleOverlay::SubtitleOverlay(QWidget *parent)
+    : QWidget(parent)
+{
+    setMouseTracking(true);
+    setAttribute(Qt::WA_NoSystemBackground);
+    hide();
+}
+
+void SubtitleOverlay::setCueTable(const CueTable &cues)
+{
+    m_cues = cues;
+    m_layouts.clear();
+    m_current = nullptr;
+    m_cue = -1;
+    hide();
+}
+
+QFont SubtitleOverlay::baseFont() const
+{
+    QFont font = QWidget::font();
+    font.setPixelSize(qBound(14, parentWidget()->height() / 18, 72));
+    return font;
+}
+
+void SubtitleOverlay::parentResized()
+{
+    //layouts depend on the font size and the available width
+    m_layouts.clear();
+    m_current = nullptr;
+
+    const int cue = m_cue;
+    m_cue = -1;
+    showCue(cue);
+}
+
+void SubtitleOverlay::showCue(int cue)
+{
+    if (cue == m_cue && m_current)
+    {
+        return;
+    }
+
+    m_cue = cue;
+    if (cue < 0 || cue >= m_cues.size() || m_cues.at(cue).textLength == 0)
+    {
+        m_current = nullptr;
+        hide();
+        return;
+    }
+
+    m_current = &layout(cue);
+
+    const QWidget *video = parentWidget();
+    const QRect rect(QPoint((video->width() - m_current->size.width()) / 2,
+                            video->height() - m_current->size.height() - video->height() / 16),
+                     m_current->size);
+
+    if (geometry() != rect)
+    {
+        setGeometry(rect);
+    }
+    update();
+    show();
+    raise();
+}
+
+const SubtitleOverlay::Layout &SubtitleOverlay::layout(int cue)
+{
+    auto it = m_layouts.find(cue);
+    if (it == m_layouts.end())
+    {
+        if (m_layouts.size() >= MAX_LAYOUTS)
+        {
+            m_layouts.clear();
+        }
+        it = m_layouts.insert(cue, buildLayout(cue));
+    }
+    return it.value();
+}
+
+SubtitleOverlay::Layout SubtitleOverlay::buildLayout(int cue) const
+{
+    Layout layout;
+    layout.font = baseFont();
+
+    const QString &buffer = m_cues.textBuffer();
+    const CueTable::Cue &entry = m_cues.at(cue);
+    const int begin = entry.textOffset;
+    const int end = begin + entry.textLength;
+
+    //visible text of each line, with markup dropped; visibleAt maps a
+    //buffer offset to its position in that line
+    QStringList lines;
+    QVector<int> visibleAt(entry.textLength + 1, 0);
+    QVector<int> lineOf(entry.textLength + 1, 0);
+    QString line;
+
+    for (int i = begin; i < end; ++i)
+    {
+        const QChar c = buffer.at(i);
+        visibleAt[i - begin] = line.size();
+        lineOf[i - begin] = lines.size();
+
+        if (c == '\n')
+        {
+            lines.push_back(line);
+            line.clear();
+            continue;
+        }
+
+        if (c == '<' || c == '{')
+        {
+            //same rule as the tokenizer: markup closes on its own line
+            const QChar close = c == '<' ? QChar('>') : QChar('}');
+            int j = i + 1;
+            while (j < end && buffer.at(j) != close && buffer.at(j) != '\n')
+            {
+                ++j;
+            }
+            if (j < end && buffer.at(j) == close)
+            {
+                for (int k = i + 1; k <= j; ++k)
+                {
+                    visibleAt[k - begin] = line.size();
+                    lineOf[k - begin] = lines.size();
+                }
+                i = j;
+                continue;
+            }
+        }
+
+        line += c;
+    }
+    visibleAt[entry.textLength] = line.size();
+    lineOf[entry.textLength] = lines.size();
+    lines.push_back(line);
+
+    //shrink long cues to the width of the video rather than wrapping them
+    const qreal available = qMax(1, parentWidget()->width() - 4 * MARGIN);
+    QFontMetricsF metrics(layout.font);
+    qreal widest = 0;
+    for (const QString &text : lines)
+    {
+        widest = qMax(widest, metrics.horizontalAdvance(text));
+    }
+    if (widest > available)
+    {
+        layout.font.setPixelSize(qMax(8, int(layout.font.pixelSize() * available / widest)));
+        metrics = QFontMetricsF(layout.font);
+        widest = 0;
+        for (const QString &text : lines)
+        {
+            widest = qMax(widest, metrics.horizontalAdvance(text));
+        }
+    }
+
+    const qreal lineHeight = metrics.lineSpacing();
+    layout.size = QSize(int(widest) + 2 * MARGIN + 1, int(lineHeight * lines.size()) + 2 * MARGIN);
+
+    QVector<qreal> left;
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        QStaticText text(lines.at(i));
+        text.setTextFormat(Qt::PlainText);
+        text.setPerformanceHint(QStaticText::AggressiveCaching);
+        text.prepare(QTransform(), layout.font);
+
+        const QPointF origin((layout.size.width() - metrics.horizontalAdvance(lines.at(i))) / 2, MARGIN + i * lineHeight);
+        layout.lines.push_back(text);
+        layout.origins.push_back(origin);
+    }
+
+    for (int token = 0; token < entry.tokenCount; ++token)
+    {
+        const CueTable::Token &span = m_cues.tokenData()[entry.firstToken + token];
+        const int first = span.offset - begin;
+        const int row = lineOf.at(first);
+        const QString &text = lines.at(row);
+        const int from = visibleAt.at(first);
+        const int to = visibleAt.at(first + span.length);
+
+        const qreal x = layout.origins.at(row).x() + metrics.horizontalAdvance(text.left(from));
+        const qreal width = metrics.horizontalAdvance(text.mid(from, to - from));
+        layout.words.push_back({QRectF(x, layout.origins.at(row).y(), width, lineHeight), token});
+    }
+
+    return layout;
+}
+
+void SubtitleOverlay::paintEvent(QPaintEvent *)
+{
+    if (!m_current)
+    {
+        return;
+    }
+
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(0, 0, 0, 170));
+    painter.drawRoundedRect(rect(), MARGIN, MARGIN);
+
+    painter.setFont(m_current->font);
+    painter.setPen(Qt::white);
+    for (int i = 0; i < m_current->lines.size(); ++i)
+    {
+        painter.drawStaticText(m_current->origins.at(i), m_current->lines.at(i));
+    }
+}
+
+int SubtitleOverlay::wordAt(const QPoint &pos) const
+{
+    if (!m_current)
+    {
+        return -1;
+    }
+
+    for (const Word &word : m_current->words)
+    {
+        if (word.rect.contains(pos))
+        {
+            return word.token;
+        }
+    }
+    return -1;
+}
+
+void SubtitleOverlay::mousePressEvent(QMouseEvent *event)
+{
+    const int token = wordAt(event->pos());
+    if (event->button() == Qt::LeftButton && token >= 0)
+    {
+        emit wordClicked(m_cues.tokenRef(m_cue, token).toString());
+        event->accept();
+        return;
+    }
+
+    QWidget::mousePressEvent(event);
+}
+
+void SubtitleOverlay::mouseMoveEvent(QMouseEvent *event)
+{
+    setCursor(wordAt(event->pos()) >= 0 ? Qt::PointingHandCursor : Qt::ArrowCursor);
+    QWidget::mouseMoveEvent(event);
+}
@@ -0,0 +1,70 @@
+#ifndef SUBTITLEOVERLAY_H
+#define SUBTITLEOVERLAY_H
+
+#include "cuetable.h"
+
+#include <QHash>
+#include <QRectF>
+#include <QStaticText>
+#include <QWidget>
+
+//Paints the current cue on top of the video.
+//Each cue is laid out once into pre-shaped QStaticText lines plus one
+//hit rectangle per word (from the cue's token spans); layouts are cached
+//until the table, the font or the available width changes, so showing a
+//cue again is a hash lookup and a repaint of the overlay rectangle.
+//The font scales with the height of the parent, which keeps the overlay
+//readable in fullscreen.
+//The overlay is an ordinary (alien) child widget. It only reliably shows
+//over the picture when the video widget paints its frames itself. A
+//backend that renders into a native window of its own, through a window
+//or widget control, may draw the video over it.
+class SubtitleOverlay : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SubtitleOverlay(QWidget *parent);
+
+    void setCueTable(const CueTable &cues);
+    void showCue(int cue);
+
+    //re-fits the overlay after the parent changed size
+    void parentResized();
+
+signals:
+    void wordClicked(const QString &word);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+private:
+    struct Word
+    {
+        QRectF rect;
+        int token;
+    };
+
+    struct Layout
+    {
+        QFont font;
+        QVector<QStaticText> lines;
+        QVector<QPointF> origins;
+        QVector<Word> words;
+        QSize size;
+    };
+
+    const Layout &layout(int cue);
+    Layout buildLayout(int cue) const;
+    int wordAt(const QPoint &pos) const;
+    QFont baseFont() const;
+
+    CueTable m_cues;
+    int m_cue = -1;
+    QHash<int, Layout> m_layouts;
+    const Layout *m_current = nullptr;
+};
+
+#endif // SUBTITLEOVERLAY_H
@@ -0,0 +1,97 @@
+#ifndef SUBTITLEPARSERS_P_H
+#define SUBTITLEPARSERS_P_H
+
+#include <QChar>
+
+//Line scanning shared by the subtitle parsers. All helpers work on the
+//decoded buffer in place; nothing here allocates.
+namespace SubtitleText
+{
+
+struct Line
+{
+    int begin;
+    int end;    //excludes the line terminator and any trailing '\r'
+    int next;   //start of the following line
+};
+
+inline Line lineAt(const QChar *data, int size, int pos)
+{
+    int end = pos;
+    while (end < size && data[end] != QLatin1Char('\n'))
+    {
+        ++end;
+    }
+
+    const int next = end < size ? end + 1 : end;
+    if (end > pos && data[end - 1] == QLatin1Char('\r'))
+    {
+        --end;
+    }
+
+    return {pos, end, next};
+}
+
+inline bool isBlank(const QChar *data, const Line &line)
+{
+    for (int i = line.begin; i < line.end; ++i)
+    {
+        if (!data[i].isSpace())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool isIndex(const QChar *data, const Line &line)
+{
+    if (line.begin == line.end)
+    {
+        return false;
+    }
+
+    for (int i = line.begin; i < line.end; ++i)
+    {
+        if (!data[i].isDigit() && !data[i].isSpace())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline int findArrow(const QChar *data, const Line &line)
+{
+    for (int i = line.begin; i + 2 < line.end; ++i)
+    {
+        if (data[i] == QLatin1Char('-') && data[i + 1] == QLatin1Char('-') && data[i + 2] == QLatin1Char('>'))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+inline bool startsWith(const QChar *data, const Line &line, const char *prefix)
+{
+    int i = line.begin;
+    for (; *prefix; ++prefix, ++i)
+    {
+        if (i >= line.end || data[i] != QLatin1Char(*prefix))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline int skipBom(const QChar *data, int size)
+{
+    //decoders keep a UTF-8 BOM as U+FEFF
+    return size > 0 && data[0] == QChar(0xFEFF) ? 1 : 0;
+}
+
+} // namespace SubtitleText
+
+#endif // SUBTITLEPARSERS_P_H
@@ -0,0 +1,56 @@
+#include "subtitlescheduler.h"
+
+#include "playbackclock.h"
+
+#include <cmath>
+#include <limits>
+
+SubtitleScheduler::SubtitleScheduler(PlaybackClock *clock, QObject *parent)
+    : QObject(parent)
+    , m_clock(clock)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &SubtitleScheduler::reschedule);
+
+    //changed also covers seeks via setPosition()
+    connect(m_clock, &PlaybackClock::changed, this, &SubtitleScheduler::reschedule);
+}
+
+void SubtitleScheduler::setCueTable(const CueTable &cues)
+{
+    m_cues = cues;
+    m_currentCue = -1;
+    emit cueChanged(-1);
+    reschedule();
+}
+
+void SubtitleScheduler::reschedule()
+{
+    m_timer.stop();
+
+    const qint64 position = m_clock->position();
+    const int cue = m_cues.find(position, m_currentCue);
+
+    if (cue != m_currentCue)
+    {
+        m_currentCue = cue;
+        emit cueChanged(cue);
+    }
+
+    //nothing moves while paused or stopped; the next clock change wakes us
+    if (!m_clock->isPlaying())
+    {
+        return;
+    }
+
+    const qint64 boundary = m_cues.nextBoundary(position);
+    if (boundary == std::numeric_limits<qint64>::max())
+    {
+        return;
+    }
+
+    //round up so the timer never fires just short of the boundary
+    const qint64 delay = qMax<qint64>(1, qint64(std::ceil((boundary - position) / m_clock->rate())));
+    m_timer.start(int(qMin<qint64>(delay, std::numeric_limits<int>::max())));
+}
@@ -0,0 +1,37 @@
+#ifndef SUBTITLESCHEDULER_H
+#define SUBTITLESCHEDULER_H
+
+#include "cuetable.h"
+
+#include <QObject>
+#include <QTimer>
+
+class PlaybackClock;
+
+//Drives the visible subtitle from the playback clock instead of polling.
+//Sleeps until the next cue boundary and re-evaluates whenever the clock
+//is seeked, corrected, paused or changes rate; emits only when the
+//visible cue changes.
+class SubtitleScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SubtitleScheduler(PlaybackClock *clock, QObject *parent = nullptr);
+
+    void setCueTable(const CueTable &cues);
+
+public slots:
+    void reschedule();
+
+signals:
+    void cueChanged(int cue);
+
+private:
+    PlaybackClock *m_clock = nullptr;
+    QTimer m_timer;
+    CueTable m_cues;
+    int m_currentCue = -1;
+};
+
+#endif // SUBTITLESCHEDULER_H
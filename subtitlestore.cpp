@@ -0,0 +1,69 @@
+#include "subtitlestore.h"
+
+#include <atomic>
+
+CueTable SubtitleSnapshot::track(int row) const
+{
+    return row >= 0 && row < tracks.size() ? tracks.at(row) : CueTable();
+}
+
+SubtitleStore::SubtitleStore()
+    : m_current(std::make_shared<SubtitleSnapshot>())
+{
+}
+
+SubtitleStore::Snapshot SubtitleStore::snapshot() const
+{
+    return std::atomic_load_explicit(&m_current, std::memory_order_acquire);
+}
+
+int SubtitleStore::appendRows(int count)
+{
+    const int first = m_current->tracks.size();
+    insertRows(first, count);
+    return first;
+}
+
+void SubtitleStore::insertRows(int row, int count)
+{
+    if (count > 0)
+    {
+        QVector<CueTable> tracks = m_current->tracks;
+        tracks.insert(qBound(0, row, tracks.size()), count, CueTable());
+        publish(tracks);
+    }
+}
+
+void SubtitleStore::set(int row, const CueTable &cues)
+{
+    setMany(QVector<QPair<int, CueTable>>{qMakePair(row, cues)});
+}
+
+void SubtitleStore::setMany(const QVector<QPair<int, CueTable>> &rows)
+{
+    QVector<CueTable> tracks = m_current->tracks;
+    bool changed = false;
+    for (const auto &row : rows)
+    {
+        if (row.first >= 0 && row.first < tracks.size())
+        {
+            tracks[row.first] = row.second;
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        publish(tracks);
+    }
+}
+
+void SubtitleStore::publish(QVector<CueTable> tracks)
+{
+    //the writer is the only one replacing m_current, so reading it plainly above is safe
+    auto next = std::make_shared<SubtitleSnapshot>();
+    next->tracks = std::move(tracks);
+    next->generation = m_current->generation + 1;
+
+    std::atomic_store_explicit(&m_current, Snapshot(std::move(next)), std::memory_order_release);
+}
@@ -0,0 +1,51 @@
+#ifndef SUBTITLESTORE_H
+#define SUBTITLESTORE_H
+
+#include "cuetable.h"
+
+#include <QPair>
+#include <QVector>
+
+#include <memory>
+
+//Immutable set of cue tables, one per playlist row.
+struct SubtitleSnapshot
+{
+    QVector<CueTable> tracks;
+    quint64 generation = 0;
+
+    int size() const { return tracks.size(); }
+    //an empty table for rows without subtitles or out of range
+    CueTable track(int row) const;
+};
+
+//Publishes subtitle snapshots RCU-style.
+//Only the GUI thread writes: every change copies the (implicitly shared)
+//track list, edits the copy and swaps it in atomically. Readers on any
+//thread pin the current snapshot with snapshot() and keep using it
+//unchanged for as long as they hold it, without locks or deep copies;
+//a superseded snapshot is freed when its last reader lets go.
+class SubtitleStore
+{
+public:
+    typedef std::shared_ptr<const SubtitleSnapshot> Snapshot;
+
+    SubtitleStore();
+
+    Snapshot snapshot() const;
+
+    //writer side, GUI thread only; new rows start without subtitles
+    int appendRows(int count);
+    //rows from row on move down by count
+    void insertRows(int row, int count);
+    void set(int row, const CueTable &cues);
+    //one copy and one snapshot for a whole batch of rows
+    void setMany(const QVector<QPair<int, CueTable>> &rows);
+
+private:
+    void publish(QVector<CueTable> tracks);
+
+    Snapshot m_current;
+};
+
+#endif // SUBTITLESTORE_H
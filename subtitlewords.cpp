@@ -0,0 +1,339 @@
+#include "subtitlewords.h"
+
+#include "cuetable.h"
+
+#include <QSet>
+#include <QtAlgorithms>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SUBTITLEWORDS_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SUBTITLEWORDS_SSE2
+#endif
+
+namespace SubtitleWords
+{
+
+static inline bool isAsciiLetter(ushort c)
+{
+    return ushort((c | 0x20) - 'a') < 26;
+}
+
+static inline bool isWordStart(ushort c)
+{
+    return isAsciiLetter(c) || (c >= 0x80 && QChar(c).isLetter());
+}
+
+static inline bool isWordPart(ushort c)
+{
+    return isAsciiLetter(c) || (c >= 0x80 && (QChar(c).isLetter() || QChar(c).isMark()));
+}
+
+static inline bool isJoiner(ushort c)
+{
+    return c == '\'' || c == '-' || c == 0x2019 || c == 0x2010;
+}
+
+//Block classification: one bit per UTF-16 unit for ASCII letters, ASCII
+//joiners, and "special" units (anything outside ASCII, '<', '{') that
+//need the scalar path. A unit is an ASCII letter when (c | 0x20) - 'a'
+//lies in [0, 26) as a signed 16-bit value, which nothing at or above
+//0x80 does.
+struct BlockMasks
+{
+    quint32 letters;
+    quint32 joiners;
+    quint32 special;
+};
+
+#if defined(SUBTITLEWORDS_AVX2)
+
+static const int BLOCK = 32;
+static const quint32 BLOCK_BITS = 0xffffffffu;
+
+static inline void classify(__m256i v, __m256i *letters, __m256i *joiners, __m256i *special)
+{
+    const __m256i x = _mm256_sub_epi16(_mm256_or_si256(v, _mm256_set1_epi16(0x20)), _mm256_set1_epi16('a'));
+    *letters = _mm256_and_si256(_mm256_cmpgt_epi16(x, _mm256_set1_epi16(-1)),
+                                _mm256_cmpgt_epi16(_mm256_set1_epi16(26), x));
+    *joiners = _mm256_or_si256(_mm256_cmpeq_epi16(v, _mm256_set1_epi16('\'')),
+                               _mm256_cmpeq_epi16(v, _mm256_set1_epi16('-')));
+    const __m256i ascii = _mm256_cmpeq_epi16(_mm256_and_si256(v, _mm256_set1_epi16(short(0xff80))), _mm256_setzero_si256());
+    *special = _mm256_or_si256(_mm256_andnot_si256(ascii, _mm256_set1_epi16(-1)),
+                               _mm256_or_si256(_mm256_cmpeq_epi16(v, _mm256_set1_epi16('<')),
+                                               _mm256_cmpeq_epi16(v, _mm256_set1_epi16('{'))));
+}
+
+//packs two 16-lane masks into one bit per lane, in order
+static inline quint32 bits(__m256i lo, __m256i hi)
+{
+    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), 0xd8);
+    return quint32(_mm256_movemask_epi8(packed));
+}
+
+static inline BlockMasks classifyBlock(const ushort *p)
+{
+    __m256i letters[2], joiners[2], special[2];
+    for (int half = 0; half < 2; ++half)
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + half * 16));
+        classify(v, &letters[half], &joiners[half], &special[half]);
+    }
+    return {bits(letters[0], letters[1]), bits(joiners[0], joiners[1]), bits(special[0], special[1])};
+}
+
+#elif defined(SUBTITLEWORDS_SSE2)
+
+static const int BLOCK = 16;
+static const quint32 BLOCK_BITS = 0xffffu;
+
+static inline void classify(__m128i v, __m128i *letters, __m128i *joiners, __m128i *special)
+{
+    const __m128i x = _mm_sub_epi16(_mm_or_si128(v, _mm_set1_epi16(0x20)), _mm_set1_epi16('a'));
+    *letters = _mm_and_si128(_mm_cmpgt_epi16(x, _mm_set1_epi16(-1)),
+                             _mm_cmplt_epi16(x, _mm_set1_epi16(26)));
+    *joiners = _mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16('\'')),
+                            _mm_cmpeq_epi16(v, _mm_set1_epi16('-')));
+    const __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(short(0xff80))), _mm_setzero_si128());
+    *special = _mm_or_si128(_mm_andnot_si128(ascii, _mm_set1_epi16(-1)),
+                            _mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16('<')),
+                                         _mm_cmpeq_epi16(v, _mm_set1_epi16('{'))));
+}
+
+static inline quint32 bits(__m128i lo, __m128i hi)
+{
+    return quint32(_mm_movemask_epi8(_mm_packs_epi16(lo, hi)));
+}
+
+static inline BlockMasks classifyBlock(const ushort *p)
+{
+    __m128i letters[2], joiners[2], special[2];
+    for (int half = 0; half < 2; ++half)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + half * 8));
+        classify(v, &letters[half], &joiners[half], &special[half]);
+    }
+    return {bits(letters[0], letters[1]), bits(joiners[0], joiners[1]), bits(special[0], special[1])};
+}
+
+#endif
+
+namespace {
+
+//word state shared by the scalar and the block path
+struct Tokenizer
+{
+    const ushort *p;
+    int length;
+    QVector<Span> *spans;
+    int base;
+    int start;          //first unit of the word in progress, or -1
+
+    Tokenizer(const ushort *text, int size, QVector<Span> *out, int offset)
+        : p(text)
+        , length(size)
+        , spans(out)
+        , base(offset)
+        , start(-1)
+    {
+    }
+
+    void finish(int end)
+    {
+        spans->push_back({base + start, end - start});
+        start = -1;
+    }
+
+    //consumes at least one unit at i, returns the next position
+    int step(int i)
+    {
+        const ushort c = p[i];
+
+        if (start >= 0)
+        {
+            if (isWordPart(c) || (isJoiner(c) && i + 1 < length && isWordStart(p[i + 1])))
+            {
+                return i + 1;
+            }
+            finish(i);
+        }
+
+        if (c == '<' || c == '{')
+        {
+            //markup ends on the same line; a lone bracket is just punctuation
+            const ushort close = c == '<' ? '>' : '}';
+            int end = i + 1;
+            while (end < length && p[end] != close && p[end] != '\n')
+            {
+                ++end;
+            }
+            return end < length && p[end] == close ? end + 1 : i + 1;
+        }
+
+        if (isWordStart(c))
+        {
+            start = i;
+        }
+        return i + 1;
+    }
+
+#if defined(SUBTITLEWORDS_AVX2) || defined(SUBTITLEWORDS_SSE2)
+    //a block of plain ASCII: word boundaries are the edges of the letter mask
+    void block(int i, const BlockMasks &masks)
+    {
+        const quint32 carry = start >= 0 ? 1 : 0;
+        const quint32 next = i + BLOCK < length && isWordStart(p[i + BLOCK]) ? 1 : 0;
+
+        const quint32 previous = (masks.letters << 1) | carry;
+        const quint32 following = (masks.letters >> 1) | (next << (BLOCK - 1));
+        const quint32 word = (masks.letters | (masks.joiners & previous & following)) & BLOCK_BITS;
+
+        const quint32 shifted = (word << 1) | carry;
+        const quint32 starts = word & ~shifted;
+        quint32 edges = (starts | (~word & shifted)) & BLOCK_BITS;
+
+        while (edges)
+        {
+            const int lane = int(qCountTrailingZeroBits(edges));
+            //edges alternate between word starts and ends
+            if (start < 0)
+            {
+                start = i + lane;
+            }
+            else
+            {
+                finish(i + lane);
+            }
+            edges &= edges - 1;
+        }
+    }
+#endif
+
+    void run()
+    {
+        int i = 0;
+#if defined(SUBTITLEWORDS_AVX2) || defined(SUBTITLEWORDS_SSE2)
+        while (i + BLOCK <= length)
+        {
+            const BlockMasks masks = classifyBlock(p + i);
+            if (masks.special == 0)
+            {
+                block(i, masks);
+                i += BLOCK;
+                continue;
+            }
+
+            //scalar up to and including the first special unit, then back to blocks
+            const int special = i + int(qCountTrailingZeroBits(masks.special));
+            while (i <= special)
+            {
+                i = step(i);
+            }
+        }
+#endif
+        while (i < length)
+        {
+            i = step(i);
+        }
+
+        if (start >= 0)
+        {
+            finish(length);
+        }
+    }
+};
+
+} // namespace
+
+static const QSet<QString> &stopWords()
+{
+    static const QSet<QString> words = {
+        "the", "and", "for", "are", "but", "not", "you", "all", "any", "can", "had", "her", "was",
+        "one", "our", "out", "day", "get", "has", "him", "his", "how", "man", "new", "now", "old",
+        "see", "two", "way", "who", "boy", "did", "its", "let", "put", "say", "she", "too", "use",
+        "yes", "yeah", "okay", "that", "with", "have", "this", "will", "your", "from", "they",
+        "know", "want", "been", "good", "much", "some", "time", "very", "when", "come", "here",
+        "just", "like", "long", "make", "many", "more", "only", "over", "such", "take", "than",
+        "them", "well", "were", "what", "where", "which", "while", "there", "their", "these",
+        "those", "would", "could", "should", "about", "after", "again", "because", "being",
+        "into", "then", "why", "going", "gonna", "wanna", "don't", "didn't", "can't", "won't",
+        "i'm", "it's", "you're", "that's", "there's", "we're", "they're", "i've", "i'll", "let's"
+    };
+    return words;
+}
+
+bool isStopWord(const QString &word)
+{
+    return stopWords().contains(word);
+}
+
+void tokenize(const QChar *text, int length, QVector<Span> *spans, int base)
+{
+    Tokenizer tokenizer(reinterpret_cast<const ushort *>(text), length, spans, base);
+    tokenizer.run();
+}
+
+QString fold(const QStringRef &word)
+{
+    QString folded = word.toString().toLower();
+    folded.replace(QChar(0x2019), QLatin1Char('\''));
+    folded.replace(QChar(0x2010), QLatin1Char('-'));
+    return folded;
+}
+
+QStringList wordsOf(const QStringRef &text)
+{
+    QVector<Span> spans;
+    tokenize(text.unicode(), text.size(), &spans);
+
+    QStringList words;
+    for (const Span &span : spans)
+    {
+        if (span.length >= 3)
+        {
+            words.push_back(fold(text.mid(span.offset, span.length)));
+        }
+    }
+    return words;
+}
+
+QStringList wordsOf(const CueTable &cues, int cue)
+{
+    //spans were found when the cue was loaded
+    QStringList words;
+    for (int i = 0; i < cues.tokenCount(cue); ++i)
+    {
+        const QStringRef word = cues.tokenRef(cue, i);
+        if (word.size() >= 3)
+        {
+            words.push_back(fold(word));
+        }
+    }
+    return words;
+}
+
+QString wordAt(const QString &text, int position)
+{
+    QVector<Span> spans;
+    tokenize(text.constData(), text.size(), &spans);
+
+    for (const Span &span : spans)
+    {
+        if (position >= span.offset && position <= span.offset + span.length)
+        {
+            return text.mid(span.offset, span.length);
+        }
+    }
+    return QString();
+}
+
+QString normalized(const QString &word)
+{
+    //same folding as wordsOf(), for words typed by the user
+    const QStringList words = wordsOf(QStringRef(&word));
+    return words.isEmpty() ? QString() : words.first();
+}
+
+} // namespace SubtitleWords
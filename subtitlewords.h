@@ -0,0 +1,37 @@
+#ifndef SUBTITLEWORDS_H
+#define SUBTITLEWORDS_H
+
+#include <QStringList>
+#include <QVector>
+
+class CueTable;
+
+//Word splitting shared by everything that looks at cue text.
+//A word is a run of letters (and combining marks); an apostrophe or
+//hyphen between two letters keeps it together ("don't", "well-known").
+//<i> and {\an8} style markup is skipped. Runs of ASCII are scanned with
+//SSE2, or AVX2 when the build enables it; everything else takes the
+//scalar path. Folded words are lower-cased with typographic apostrophes
+//turned into '; wordsOf() keeps those at least three letters long.
+namespace SubtitleWords
+{
+
+struct Span
+{
+    qint32 offset;
+    qint32 length;
+};
+
+//appends the words of text to spans, offsets shifted by base
+void tokenize(const QChar *text, int length, QVector<Span> *spans, int base = 0);
+
+QString fold(const QStringRef &word);
+QStringList wordsOf(const QStringRef &text);
+QStringList wordsOf(const CueTable &cues, int cue);
+QString wordAt(const QString &text, int position);
+QString normalized(const QString &word);
+bool isStopWord(const QString &word);
+
+} // namespace SubtitleWords
+
+#endif // SUBTITLEWORDS_H
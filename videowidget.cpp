@@ -49,6 +49,7 @@
 ****************************************************************************/
 
 #include "videowidget.h"
+#include "subtitleoverlay.h"
 
 #include <QKeyEvent>
 #include <QMouseEvent>
@@ -63,6 +64,20 @@ VideoWidget::VideoWidget(QWidget *parent)
     setPalette(p);
 
     setAttribute(Qt::WA_OpaquePaintEvent);
+
+    //a child widget, so it follows the video into fullscreen
+    m_subtitles = new SubtitleOverlay(this);
+    connect(m_subtitles, &SubtitleOverlay::wordClicked, this, &VideoWidget::wordClicked);
+}
+
+void VideoWidget::setCueTable(const CueTable &cues)
+{
+    m_subtitles->setCueTable(cues);
+}
+
+void VideoWidget::showCue(int cue)
+{
+    m_subtitles->showCue(cue);
 }
 
 void VideoWidget::keyPressEvent(QKeyEvent *event)
@@ -83,3 +98,8 @@ void VideoWidget::mousePressEvent(QMouseEvent *event)
     QVideoWidget::mousePressEvent(event);
 }
 
+void VideoWidget::resizeEvent(QResizeEvent *event)
+{
+    QVideoWidget::resizeEvent(event);
+    m_subtitles->parentResized();
+}
@@ -51,8 +51,12 @@
 #ifndef VIDEOWIDGET_H
 #define VIDEOWIDGET_H
 
+#include "cuetable.h"
+
 #include <QVideoWidget>
 
+class SubtitleOverlay;
+
 class VideoWidget : public QVideoWidget
 {
     Q_OBJECT
@@ -60,9 +64,21 @@ class VideoWidget : public QVideoWidget
 public:
     explicit VideoWidget(QWidget *parent = nullptr);
 
+    void setCueTable(const CueTable &cues);
+
+public slots:
+    void showCue(int cue);
+
+signals:
+    void wordClicked(const QString &word);
+
 protected:
     void keyPressEvent(QKeyEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    SubtitleOverlay *m_subtitles = nullptr;
 };
 
 #endif // VIDEOWIDGET_H
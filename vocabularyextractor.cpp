@@ -0,0 +1,358 @@
+#include "vocabularyextractor.h"
+
+#include "definitionparser.h"
+#include "dictionarybackend.h"
+#include "dictionarycache.h"
+#include "lemmatizer.h"
+#include "mediascanner.h"
+#include "subtitleloader.h"
+#include "subtitlewords.h"
+
+#include <QDebug>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+QVector<MediaScanner::Pair> collect(const QStringList &paths)
+{
+    const QStringList mediaSuffixes = MediaScanner::mediaSuffixes();
+    const QStringList subtitleSuffixes = SubtitleLoader::suffixes();
+
+    QStringList directories;
+    QStringList mediaFiles;
+    QStringList subtitleFiles;
+
+    for (const QString &path : paths)
+    {
+        const QFileInfo info(path);
+        const QString suffix = info.suffix().toLower();
+
+        if (info.isDir())
+        {
+            directories.push_back(path);
+        }
+        else if (mediaSuffixes.contains(suffix))
+        {
+            mediaFiles.push_back(path);
+        }
+        else if (subtitleSuffixes.contains(suffix))
+        {
+            subtitleFiles.push_back(path);
+        }
+        else
+        {
+            qWarning() << "Skipping" << path << ": not a folder, video or subtitle file";
+        }
+    }
+
+    mediaFiles += MediaScanner::walk(directories);
+    for (const QString &directory : directories)
+    {
+        QDirIterator it(directory, SubtitleLoader::nameFilters(), QDir::Files, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+        while (it.hasNext())
+        {
+            subtitleFiles.push_back(it.next());
+        }
+    }
+
+    QVector<MediaScanner::Pair> pairs = MediaScanner::pair(mediaFiles);
+
+    //subtitle files that belong to a video are read through it
+    QSet<QString> taken;
+    for (const MediaScanner::Pair &pair : pairs)
+    {
+        if (!pair.subtitle.isEmpty())
+        {
+            taken.insert(QFileInfo(pair.subtitle).absoluteFilePath());
+        }
+    }
+
+    for (const QString &subtitleFile : subtitleFiles)
+    {
+        const QString path = QFileInfo(subtitleFile).absoluteFilePath();
+        if (!taken.contains(path))
+        {
+            taken.insert(path);
+            pairs.push_back({subtitleFile, subtitleFile});
+        }
+    }
+
+    return pairs;
+}
+
+QString csvField(const QString &field)
+{
+    if (!field.contains(',') && !field.contains('"') && !field.contains('\n'))
+    {
+        return field;
+    }
+
+    QString quoted = field;
+    quoted.replace('"', QLatin1String("\"\""));
+    return '"' + quoted + '"';
+}
+
+void writeCsvRow(QTextStream &out, const QString &scope, const VocabularyExtractor::Word &word)
+{
+    out << csvField(scope) << ','
+        << csvField(word.word) << ','
+        << word.count << ','
+        << word.files << ','
+        << csvField(word.media) << ','
+        << (word.firstSeen >= 0 ? CueTable::formatTimestamp(word.firstSeen) : QString()) << ','
+        << csvField(word.example) << ','
+        << csvField(word.definition) << '\n';
+}
+
+QJsonArray wordsToJson(const QVector<VocabularyExtractor::Word> &words, bool aggregate)
+{
+    QJsonArray array;
+    for (const VocabularyExtractor::Word &word : words)
+    {
+        QJsonObject object;
+        object.insert("word", word.word);
+        object.insert("count", word.count);
+        if (aggregate)
+        {
+            object.insert("files", word.files);
+            object.insert("file", word.media);
+        }
+        object.insert("time", CueTable::formatTimestamp(word.firstSeen));
+        object.insert("example", word.example);
+        if (!word.definition.isEmpty())
+        {
+            object.insert("definition", word.definition);
+        }
+        array.append(object);
+    }
+    return array;
+}
+
+} // namespace
+
+VocabularyExtractor::VocabularyExtractor(const Options &options)
+    : m_options(options)
+{
+}
+
+VocabularyExtractor::FileReport VocabularyExtractor::extract(const QString &media, const QString &subtitle,
+                                                             bool includeStopWords)
+{
+    const MediaScanner::Result result = MediaScanner::load({media, subtitle});
+    const CueTable &cues = result.cues;
+
+    FileReport report;
+    report.media = media;
+    report.subtitle = result.subtitle;
+    report.cues = cues.size();
+
+    QHash<QString, int> seen;
+    for (int i = 0; i < cues.size(); ++i)
+    {
+        for (const QString &word : SubtitleWords::wordsOf(cues, i))
+        {
+            ++report.tokens;
+            if (!includeStopWords && SubtitleWords::isStopWord(word))
+            {
+                continue;
+            }
+
+            auto it = seen.find(word);
+            if (it != seen.end())
+            {
+                ++report.words[it.value()].count;
+                continue;
+            }
+
+            seen.insert(word, report.words.size());
+
+            Word entry;
+            entry.word = word;
+            entry.count = 1;
+            entry.files = 1;
+            entry.firstSeen = cues.at(i).start;
+            entry.example = cues.text(i).replace('\n', ' ');
+            report.words.push_back(entry);
+        }
+    }
+
+    sortWords(&report.words);
+    return report;
+}
+
+void VocabularyExtractor::sortWords(QVector<Word> *words)
+{
+    std::sort(words->begin(), words->end(), [](const Word &a, const Word &b)
+    {
+        return a.count != b.count ? a.count > b.count : a.word < b.word;
+    });
+}
+
+bool VocabularyExtractor::run(const QStringList &paths)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const QVector<MediaScanner::Pair> pairs = collect(paths);
+
+    if (m_options.jobs > 0)
+    {
+        QThreadPool::globalInstance()->setMaxThreadCount(m_options.jobs);
+    }
+
+    const bool includeStopWords = m_options.includeStopWords;
+    std::function<FileReport(const MediaScanner::Pair &)> task = [includeStopWords](const MediaScanner::Pair &pair)
+    {
+        return extract(pair.media, pair.subtitle, includeStopWords);
+    };
+    m_files = QtConcurrent::blockingMapped<QVector<FileReport>>(pairs, task);
+
+    //merged in input order, so each word's example comes from the first file using it
+    QHash<QString, int> seen;
+    qint64 tokens = 0;
+    int withCues = 0;
+    m_words.clear();
+
+    for (FileReport &report : m_files)
+    {
+        tokens += report.tokens;
+        withCues += report.cues > 0 ? 1 : 0;
+
+        for (const Word &word : report.words)
+        {
+            auto it = seen.find(word.word);
+            if (it != seen.end())
+            {
+                Word &total = m_words[it.value()];
+                total.count += word.count;
+                ++total.files;
+                continue;
+            }
+
+            seen.insert(word.word, m_words.size());
+            m_words.push_back(word);
+            m_words.last().media = report.media;
+        }
+
+        if (!m_options.perFile)
+        {
+            report.words.clear();
+        }
+        else if (m_options.minCount > 1)
+        {
+            const int minCount = m_options.minCount;
+            report.words.erase(std::remove_if(report.words.begin(), report.words.end(),
+                                              [minCount](const Word &word) { return word.count < minCount; }),
+                               report.words.end());
+        }
+    }
+
+    if (m_options.minCount > 1)
+    {
+        const int minCount = m_options.minCount;
+        m_words.erase(std::remove_if(m_words.begin(), m_words.end(),
+                                     [minCount](const Word &word) { return word.count < minCount; }),
+                      m_words.end());
+    }
+    sortWords(&m_words);
+
+    if (m_options.cache || m_options.dictionary)
+    {
+        for (Word &word : m_words)
+        {
+            word.definition = definitionOf(word.word);
+        }
+    }
+
+    qInfo() << "Extracted" << m_words.size() << "words from" << tokens << "tokens in" << withCues << "of"
+            << pairs.size() << "files in" << timer.elapsed() << "ms on" << QThreadPool::globalInstance()->maxThreadCount() << "threads";
+
+    return withCues > 0;
+}
+
+QString VocabularyExtractor::definitionOf(const QString &word) const
+{
+    //a guessed lemma falls back to the word as written
+    QByteArray answer;
+    const QStringList keys = Lemmatizer::keys(word);
+    const auto found = std::find_if(keys.begin(), keys.end(), [this, &answer](const QString &key)
+    {
+        return (m_options.cache && m_options.cache->lookup(m_options.language, key, &answer))
+                || (m_options.dictionary && m_options.dictionary->lookup(m_options.language, key, &answer));
+    });
+    if (found == keys.end())
+    {
+        return QString();
+    }
+
+    DictionaryEntry entry;
+    if (!DefinitionParser::parse(answer, &entry) || entry.senses.isEmpty())
+    {
+        return QString();
+    }
+
+    return entry.text(entry.senses.first().definition);
+}
+
+bool VocabularyExtractor::writeCsv(QIODevice *device) const
+{
+    QTextStream out(device);
+    out.setCodec("UTF-8");
+
+    //"all" rows are the aggregate list, the others belong to the named file
+    out << "scope,word,count,files,file,time,example,definition\n";
+    for (const Word &word : m_words)
+    {
+        writeCsvRow(out, QStringLiteral("all"), word);
+    }
+
+    for (const FileReport &report : m_files)
+    {
+        for (Word word : report.words)
+        {
+            word.media = report.media;
+            writeCsvRow(out, report.media, word);
+        }
+    }
+
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
+
+bool VocabularyExtractor::writeJson(QIODevice *device) const
+{
+    QJsonArray files;
+    for (const FileReport &report : m_files)
+    {
+        QJsonObject file;
+        file.insert("media", report.media);
+        file.insert("subtitle", report.subtitle);
+        file.insert("cues", report.cues);
+        file.insert("tokens", report.tokens);
+        if (m_options.perFile)
+        {
+            file.insert("words", wordsToJson(report.words, false));
+        }
+        files.append(file);
+    }
+
+    QJsonObject root;
+    root.insert("language", m_options.language);
+    root.insert("files", files);
+    root.insert("words", wordsToJson(m_words, true));
+
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+    return device->write(json) == json.size();
+}
@@ -0,0 +1,78 @@
+#ifndef VOCABULARYEXTRACTOR_H
+#define VOCABULARYEXTRACTOR_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+class DictionaryBackend;
+class DictionaryCache;
+
+//Batch word-frequency extraction for the --headless mode.
+//Inputs may be media files, subtitle files or folders (walked like a
+//library scan; subtitle files nobody pairs with are taken on their own).
+//Each file is loaded and tokenised as one task on the global thread
+//pool, so idle workers keep pulling the next file; the per-file tables
+//are merged once at the end. Definitions come only from local sources
+//(the response cache and an offline dictionary), never the network.
+class VocabularyExtractor
+{
+public:
+    struct Options
+    {
+        int minCount = 1;
+        int jobs = 0;                   //0 = one per core
+        bool perFile = false;
+        bool includeStopWords = false;
+        QString language = "en-gb";
+        DictionaryCache *cache = nullptr;
+        DictionaryBackend *dictionary = nullptr;
+    };
+
+    struct Word
+    {
+        QString word;
+        int count = 0;
+        int files = 0;
+        QString media;                  //file the example comes from (aggregate only)
+        qint64 firstSeen = -1;          //ms into that file
+        QString example;                //text of the cue it was first seen in
+        QString definition;
+    };
+
+    struct FileReport
+    {
+        QString media;
+        QString subtitle;
+        int cues = 0;
+        int tokens = 0;
+        QVector<Word> words;            //most frequent first
+    };
+
+    explicit VocabularyExtractor(const Options &options);
+
+    //returns false when no input produced any cues
+    bool run(const QStringList &paths);
+
+    const QVector<FileReport> &files() const { return m_files; }
+    const QVector<Word> &words() const { return m_words; }
+
+    bool writeCsv(QIODevice *device) const;
+    bool writeJson(QIODevice *device) const;
+
+private:
+    static FileReport extract(const QString &media, const QString &subtitle, bool includeStopWords);
+    static void sortWords(QVector<Word> *words);
+    QString definitionOf(const QString &word) const;
+
+    Options m_options;
+    QVector<FileReport> m_files;
+    QVector<Word> m_words;
+};
+
+#endif // VOCABULARYEXTRACTOR_H
@@ -0,0 +1,104 @@
+#include "webvttparser.h"
+
+#include "subtitleparsers_p.h"
+
+using namespace SubtitleText;
+
+CueTable WebVttParser::parseText(const QString &text, int *malformed)
+{
+    const QChar *data = text.constData();
+    const int size = text.size();
+
+    CueTable cues;
+    cues.reserve(size / 48, size / 2);
+
+    int skipped = 0;
+    int pos = skipBom(data, size);
+
+    //"WEBVTT" header block runs to the first blank line
+    while (pos < size)
+    {
+        const Line line = lineAt(data, size, pos);
+        pos = line.next;
+        if (isBlank(data, line))
+        {
+            break;
+        }
+    }
+
+    while (pos < size)
+    {
+        Line line = lineAt(data, size, pos);
+        pos = line.next;
+
+        if (isBlank(data, line))
+        {
+            continue;
+        }
+
+        const bool metadata = startsWith(data, line, "NOTE") || startsWith(data, line, "STYLE")
+                || startsWith(data, line, "REGION");
+
+        //optional cue identifier
+        if (!metadata && findArrow(data, line) < 0 && pos < size)
+        {
+            const Line next = lineAt(data, size, pos);
+            if (findArrow(data, next) >= 0)
+            {
+                line = next;
+                pos = next.next;
+            }
+        }
+
+        const int arrow = metadata ? -1 : findArrow(data, line);
+        bool startOk = false;
+        bool endOk = false;
+        qint64 start = 0;
+        qint64 end = 0;
+
+        if (arrow >= 0)
+        {
+            //cue settings follow the end time and stop the timestamp parse
+            start = CueTable::parseTimestamp(QStringRef(&text, line.begin, arrow - line.begin).trimmed(), &startOk);
+            end = CueTable::parseTimestamp(QStringRef(&text, arrow + 3, line.end - arrow - 3).trimmed(), &endOk);
+        }
+
+        //payload runs to the next blank line
+        const int textBegin = pos;
+        int textEnd = pos;
+        while (pos < size)
+        {
+            const Line textLine = lineAt(data, size, pos);
+            if (isBlank(data, textLine))
+            {
+                break;
+            }
+
+            textEnd = textLine.end;
+            pos = textLine.next;
+        }
+
+        if (metadata)
+        {
+            continue;
+        }
+
+        if (!startOk || !endOk)
+        {
+            ++skipped;
+            continue;
+        }
+
+        cues.append(start, end, data + textBegin, textEnd - textBegin);
+    }
+
+    cues.sort();
+    cues.squeeze();
+
+    if (malformed)
+    {
+        *malformed = skipped;
+    }
+
+    return cues;
+}
@@ -0,0 +1,15 @@
+#ifndef WEBVTTPARSER_H
+#define WEBVTTPARSER_H
+
+#include "cuetable.h"
+
+//Single-pass WebVTT (.vtt) tokeniser.
+//Skips the header, NOTE, STYLE and REGION blocks; cue identifiers and
+//cue settings are ignored. Cue text keeps its inline markup.
+class WebVttParser
+{
+public:
+    static CueTable parseText(const QString &text, int *malformed = nullptr);
+};
+
+#endif // WEBVTTPARSER_H
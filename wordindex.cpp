@@ -0,0 +1,388 @@
+#include "wordindex.h"
+
+#include "subtitlewords.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrent>
+
+static const quint32 INDEX_MAGIC = 0x57494458; //"WIDX"
+static const quint32 INDEX_VERSION = 2;
+
+//batch disk writes while a library is being indexed
+static const int SAVE_DELAY = 5000;
+
+namespace {
+
+void writeVarint(QByteArray *out, quint32 value)
+{
+    while (value >= 0x80)
+    {
+        out->append(char(value | 0x80));
+        value >>= 7;
+    }
+    out->append(char(value));
+}
+
+quint32 readVarint(const QByteArray &data, int *pos)
+{
+    quint32 value = 0;
+    for (int shift = 0; *pos < data.size() && shift < 35; shift += 7)
+    {
+        const quint8 byte = quint8(data.at((*pos)++));
+        value |= quint32(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            break;
+        }
+    }
+    return value;
+}
+
+} // namespace
+
+WordIndex::WordIndex(const QString &fileName, QObject *parent)
+    : QObject(parent)
+    , m_fileName(fileName)
+{
+    //leave a core for playback
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(SAVE_DELAY);
+    connect(&m_saveTimer, &QTimer::timeout, this, &WordIndex::save);
+
+    load();
+}
+
+WordIndex::~WordIndex()
+{
+    m_pool.waitForDone();
+    save();
+}
+
+QString WordIndex::defaultFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/words.index";
+}
+
+WordIndex::Document WordIndex::stampOf(const QString &mediaFile, const QString &sourceFile)
+{
+    const QFileInfo info(sourceFile);
+
+    Document document;
+    document.media = mediaFile;
+    document.source = sourceFile;
+    document.size = info.size();
+    document.modified = info.lastModified().toMSecsSinceEpoch();
+    return document;
+}
+
+bool WordIndex::isIndexed(const QString &mediaFile, const QString &sourceFile) const
+{
+    const Document stamp = stampOf(mediaFile, sourceFile);
+
+    QMutexLocker locker(&m_mutex);
+    const int id = m_documentOf.value(mediaFile, -1);
+    if (id < 0)
+    {
+        return false;
+    }
+
+    const Document &document = m_documents.at(id);
+    return document.source == stamp.source && document.size == stamp.size && document.modified == stamp.modified;
+}
+
+void WordIndex::addMedia(const QString &mediaFile, const QString &sourceFile, const CueTable &cues)
+{
+    if (cues.isEmpty() || isIndexed(mediaFile, sourceFile))
+    {
+        return;
+    }
+
+    QtConcurrent::run(&m_pool, [this, mediaFile, sourceFile, cues]()
+    {
+        merge(stampOf(mediaFile, sourceFile), cues);
+        emit mediaIndexed(mediaFile);
+
+        //QTimer only starts from its own thread
+        QMetaObject::invokeMethod(&m_saveTimer, "start", Qt::QueuedConnection);
+    });
+}
+
+void WordIndex::merge(const Document &document, const CueTable &cues)
+{
+    //tokenise outside the lock; cue indices per word come out ascending
+    QHash<QString, QVector<qint32>> words;
+    for (int i = 0; i < cues.size(); ++i)
+    {
+        for (const QString &word : SubtitleWords::wordsOf(cues, i))
+        {
+            QVector<qint32> &occurrences = words[word];
+            if (occurrences.isEmpty() || occurrences.last() != i)
+            {
+                occurrences.push_back(i);
+            }
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    //another thread may have indexed the same file meanwhile
+    const int previous = m_documentOf.value(document.media, -1);
+    if (previous >= 0)
+    {
+        Document &old = m_documents[previous];
+        if (old.source == document.source && old.size == document.size && old.modified == document.modified)
+        {
+            return;
+        }
+        old.alive = false;
+        ++m_deadDocuments;
+    }
+
+    const qint32 id = m_documents.size();
+    m_documents.push_back(document);
+    m_documentOf.insert(document.media, id);
+
+    for (auto it = words.cbegin(); it != words.cend(); ++it)
+    {
+        Postings &postings = m_postings[it.key()];
+        writeVarint(&postings.data, quint32(id - postings.lastDocument));
+        writeVarint(&postings.data, quint32(it.value().size()));
+
+        qint32 cue = 0;
+        qint64 position = 0;
+        for (qint32 next : it.value())
+        {
+            //cues are sorted by start time, so both deltas are non-negative
+            const qint64 start = cues.at(next).start;
+            writeVarint(&postings.data, quint32(next - cue));
+            writeVarint(&postings.data, quint32(qMax<qint64>(0, start - position)));
+            cue = next;
+            position = qMax(position, start);
+        }
+        postings.lastDocument = id;
+    }
+
+    m_dirty = true;
+}
+
+QVector<WordIndex::Hit> WordIndex::find(const QString &word, int limit) const
+{
+    QVector<Hit> hits;
+    const QString key = SubtitleWords::normalized(word);
+
+    QMutexLocker locker(&m_mutex);
+    const auto it = m_postings.constFind(key);
+    if (it == m_postings.constEnd())
+    {
+        return hits;
+    }
+
+    const QByteArray &data = it.value().data;
+    int pos = 0;
+    qint32 document = -1;
+
+    while (pos < data.size() && hits.size() < limit)
+    {
+        document += qint32(readVarint(data, &pos));
+        const quint32 count = readVarint(data, &pos);
+        const bool alive = document >= 0 && document < m_documents.size() && m_documents.at(document).alive;
+
+        qint32 cue = 0;
+        qint64 position = 0;
+        for (quint32 i = 0; i < count && pos < data.size(); ++i)
+        {
+            cue += qint32(readVarint(data, &pos));
+            position += readVarint(data, &pos);
+            if (alive && hits.size() < limit)
+            {
+                hits.push_back({m_documents.at(document).media, cue, position});
+            }
+        }
+    }
+
+    return hits;
+}
+
+int WordIndex::documentCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_documents.size() - m_deadDocuments;
+}
+
+int WordIndex::wordCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_postings.size();
+}
+
+void WordIndex::compactLocked()
+{
+    if (m_deadDocuments == 0)
+    {
+        return;
+    }
+
+    //renumber the live documents densely
+    QVector<qint32> remap(m_documents.size(), -1);
+    QVector<Document> documents;
+    for (int i = 0; i < m_documents.size(); ++i)
+    {
+        if (m_documents.at(i).alive)
+        {
+            remap[i] = documents.size();
+            documents.push_back(m_documents.at(i));
+        }
+    }
+
+    for (auto it = m_postings.begin(); it != m_postings.end();)
+    {
+        const QByteArray &data = it.value().data;
+        Postings compacted;
+        int pos = 0;
+        qint32 document = -1;
+
+        while (pos < data.size())
+        {
+            document += qint32(readVarint(data, &pos));
+            const quint32 count = readVarint(data, &pos);
+
+            //groups are copied through without re-encoding their entries
+            const int begin = pos;
+            for (quint32 i = 0; i < count; ++i)
+            {
+                readVarint(data, &pos);
+                readVarint(data, &pos);
+            }
+
+            const qint32 id = document >= 0 && document < remap.size() ? remap.at(document) : -1;
+            if (id >= 0)
+            {
+                writeVarint(&compacted.data, quint32(id - compacted.lastDocument));
+                writeVarint(&compacted.data, count);
+                compacted.data.append(data.constData() + begin, pos - begin);
+                compacted.lastDocument = id;
+            }
+        }
+
+        if (compacted.data.isEmpty())
+        {
+            it = m_postings.erase(it);
+        }
+        else
+        {
+            it.value() = compacted;
+            ++it;
+        }
+    }
+
+    m_documents = documents;
+    m_documentOf.clear();
+    for (int i = 0; i < m_documents.size(); ++i)
+    {
+        m_documentOf.insert(m_documents.at(i).media, i);
+    }
+    m_deadDocuments = 0;
+}
+
+bool WordIndex::save()
+{
+    QMutexLocker locker(&m_mutex);
+    return saveLocked();
+}
+
+bool WordIndex::saveLocked()
+{
+    if (!m_dirty || m_fileName.isEmpty())
+    {
+        return true;
+    }
+
+    compactLocked();
+
+    QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Cannot write word index" << m_fileName << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out << INDEX_MAGIC << INDEX_VERSION << qint32(m_documents.size());
+    for (const Document &document : m_documents)
+    {
+        out << document.media << document.source << document.size << document.modified;
+    }
+
+    out << qint32(m_postings.size());
+    for (auto it = m_postings.cbegin(); it != m_postings.cend(); ++it)
+    {
+        out << it.key() << it.value().lastDocument << it.value().data;
+    }
+
+    if (!file.commit())
+    {
+        return false;
+    }
+
+    m_dirty = false;
+    return true;
+}
+
+void WordIndex::load()
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 documents = 0;
+    in >> magic >> version >> documents;
+    if (magic != INDEX_MAGIC || version != INDEX_VERSION || documents < 0)
+    {
+        return;
+    }
+
+    m_documents.reserve(qBound(0, documents, 1 << 16));
+    for (qint32 i = 0; i < documents && in.status() == QDataStream::Ok; ++i)
+    {
+        Document document;
+        in >> document.media >> document.source >> document.size >> document.modified;
+        m_documentOf.insert(document.media, m_documents.size());
+        m_documents.push_back(document);
+    }
+
+    qint32 words = 0;
+    in >> words;
+    m_postings.reserve(qBound(0, words, 1 << 20));
+    for (qint32 i = 0; i < words && in.status() == QDataStream::Ok; ++i)
+    {
+        QString word;
+        Postings postings;
+        in >> word >> postings.lastDocument >> postings.data;
+        m_postings.insert(word, postings);
+    }
+
+    //a truncated file is worse than none: everything gets re-indexed
+    if (in.status() != QDataStream::Ok)
+    {
+        m_documents.clear();
+        m_documentOf.clear();
+        m_postings.clear();
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef WORDINDEX_H
+#define WORDINDEX_H
+
+#include "cuetable.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+//Persistent inverted index: normalised word -> (media, cue, start time)
+//over every subtitle track the player has loaded.
+//Each media file is a document stamped with the size and mtime of its
+//subtitle source, so unchanged files are never re-tokenised. Tokenising
+//runs on a private thread pool; posting lists are kept varint/delta
+//encoded in memory and written as-is to disk. Replaced documents are
+//tombstoned and dropped when the index is next saved.
+class WordIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Hit
+    {
+        QString media;
+        int cue;
+        qint64 position;    //ms
+    };
+
+    explicit WordIndex(const QString &fileName, QObject *parent = nullptr);
+    ~WordIndex();
+
+    static QString defaultFileName();
+
+    //sourceFile is the subtitle file, or the media file for embedded tracks
+    void addMedia(const QString &mediaFile, const QString &sourceFile, const CueTable &cues);
+    bool isIndexed(const QString &mediaFile, const QString &sourceFile) const;
+
+    QVector<Hit> find(const QString &word, int limit = 1000) const;
+    int documentCount() const;
+    int wordCount() const;
+
+    bool save();
+
+signals:
+    void mediaIndexed(const QString &mediaFile);
+
+private:
+    struct Document
+    {
+        QString media;
+        QString source;
+        qint64 size = 0;
+        qint64 modified = 0;
+        bool alive = true;
+    };
+
+    //doc groups: varint(doc delta), varint(n), n x (varint cue delta, varint ms delta)
+    struct Postings
+    {
+        QByteArray data;
+        qint32 lastDocument = -1;
+    };
+
+    static Document stampOf(const QString &mediaFile, const QString &sourceFile);
+    void merge(const Document &document, const CueTable &cues);
+    void compactLocked();
+    bool saveLocked();
+    void load();
+
+    QString m_fileName;
+
+    mutable QMutex m_mutex;
+    QVector<Document> m_documents;      //index is the document id
+    QHash<QString, int> m_documentOf;   //media file -> live document
+    QHash<QString, Postings> m_postings;
+    int m_deadDocuments = 0;
+    bool m_dirty = false;
+
+    QThreadPool m_pool;
+    QTimer m_saveTimer;
+};
+
+#endif // WORDINDEX_H